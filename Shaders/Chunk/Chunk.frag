@@ -1,12 +1,23 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
+layout(constant_id = 0) const uint TextureCapacity = 1;
+
+struct Material {
+    uint textureIndex;
+};
+
 layout(location = 0) in vec3 inUVW;
+layout(location = 1) flat in uint inMaterialIndex;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2DArray texSampler;
+layout(set = 0, binding = 0) uniform sampler2DArray textures[TextureCapacity];
+layout(std430, set = 0, binding = 1) readonly buffer Materials {
+    Material materials[];
+};
 
 void main() {
-    outColor = texture(texSampler, inUVW);
+    // the index is the same for the whole draw
+    outColor = texture(textures[materials[inMaterialIndex].textureIndex], inUVW);
 }
\ No newline at end of file
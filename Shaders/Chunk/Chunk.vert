@@ -1,18 +1,31 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
 
-layout(push_constant) uniform MVP {
-    mat4 view;
-    mat4 position;
-} mvp;
+struct Draw {
+    vec3 origin;
+    uint materialIndex;
+    uint lod;
+};
 
+layout(set = 1, binding = 0) uniform Camera {
+    mat4 viewProjection;
+} camera;
+
+layout(std430, set = 1, binding = 1) readonly buffer Draws {
+    Draw draws[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inUVW;
 
 layout(location = 0) out vec3 outUVW;
+layout(location = 1) flat out uint outMaterialIndex;
 
 void main() {
-    gl_Position =  mvp.view * mvp.position * vec4(inPosition, 1.0);
+    // each draw passes its index as its first instance
+    Draw draw = draws[gl_InstanceIndex];
+
+    gl_Position = camera.viewProjection * vec4(inPosition + draw.origin, 1.0);
     outUVW = inUVW;
+    outMaterialIndex = draw.materialIndex;
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "BenchmarkRunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+namespace cbl::bench {
+
+namespace {
+double measureNs(std::function<void()> const &iteration, uint64_t const &iterations) {
+  auto const start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    iteration();
+  }
+  auto const end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+std::string readOption(std::string const &argument, std::string const &name) {
+  std::string const prefix = "--" + name + "=";
+  return argument.rfind(prefix, 0) == 0 ? argument.substr(prefix.size()) : std::string{};
+}
+
+uint32_t parseUnsigned(std::string const &value, std::string const &name) {
+  try {
+    return static_cast<uint32_t>(std::stoul(value));
+  } catch (std::exception const &) {
+    throw std::invalid_argument("Invalid value for --" + name + " : " + value);
+  }
+}
+
+double parseDouble(std::string const &value, std::string const &name) {
+  try {
+    return std::stod(value);
+  } catch (std::exception const &) {
+    throw std::invalid_argument("Invalid value for --" + name + " : " + value);
+  }
+}
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner(int const &argc, char const *const *argv) {
+  for (int i = 1; i < argc; i++) {
+    std::string const argument{argv[i]};
+
+    if (std::string value = readOption(argument, "filter"); !value.empty()) {
+      mFilter = value;
+    } else if (std::string value = readOption(argument, "samples"); !value.empty()) {
+      mSamples = std::max(parseUnsigned(value, "samples"), 1u);
+    } else if (std::string value = readOption(argument, "min-sample-ms"); !value.empty()) {
+      mMinSampleMs = parseDouble(value, "min-sample-ms");
+    }
+  }
+}
+
+void BenchmarkRunner::add(std::string const &name, uint64_t const &itemsPerIteration,
+                          std::function<std::function<void()>()> setup) {
+  mBenchmarks.push_back(Benchmark{name, itemsPerIteration, std::move(setup)});
+}
+
+uint64_t BenchmarkRunner::calibrate(std::function<void()> const &iteration) const {
+  // double the iteration count until one sample is long enough to be above the timer noise
+  uint64_t iterations = 1;
+  while (measureNs(iteration, iterations) < mMinSampleMs * 1000000.0 &&
+         iterations < (uint64_t{1} << 40u)) {
+    iterations *= 2;
+  }
+
+  return iterations;
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::run() const {
+  std::vector<BenchmarkResult> results{};
+
+  for (Benchmark const &benchmark : mBenchmarks) {
+    if (!mFilter.empty() && benchmark.name.find(mFilter) == std::string::npos) {
+      continue;
+    }
+
+    std::function<void()> const iteration = benchmark.setup();
+    uint64_t const iterations = calibrate(iteration);
+
+    std::vector<double> samples{};
+    samples.reserve(mSamples);
+    for (uint32_t i = 0; i < mSamples; i++) {
+      samples.push_back(measureNs(iteration, iterations) / static_cast<double>(iterations));
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkResult result{};
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.itemsPerIteration = benchmark.itemsPerIteration;
+    result.minNs = samples.front();
+    result.medianNs = samples[samples.size() / 2];
+    result.meanNs =
+        std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    result.maxNs = samples.back();
+
+    results.push_back(result);
+  }
+
+  return results;
+}
+
+void BenchmarkRunner::writeTable(std::ostream &stream,
+                                 std::vector<BenchmarkResult> const &results) {
+  stream << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "median ns"
+         << std::setw(14) << "min ns" << std::setw(14) << "max ns" << std::setw(16) << "ns/item"
+         << '\n';
+
+  for (BenchmarkResult const &result : results) {
+    stream << std::left << std::setw(40) << result.name << std::right << std::fixed
+           << std::setprecision(1) << std::setw(14) << result.medianNs << std::setw(14)
+           << result.minNs << std::setw(14) << result.maxNs << std::setw(16) << std::setprecision(3)
+           << result.medianNs / static_cast<double>(std::max(result.itemsPerIteration, uint64_t{1}))
+           << '\n';
+  }
+}
+
+void BenchmarkRunner::writeJson(std::ostream &stream, std::vector<BenchmarkResult> const &results,
+                                uint32_t const &seed) {
+  stream << std::fixed << std::setprecision(3);
+  stream << "{\n  \"seed\": " << seed << ",\n  \"benchmarks\": [";
+
+  for (size_t i = 0; i < results.size(); i++) {
+    BenchmarkResult const &result = results[i];
+
+    stream << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name
+           << "\", \"iterations\": " << result.iterations
+           << ", \"itemsPerIteration\": " << result.itemsPerIteration
+           << ", \"minNs\": " << result.minNs << ", \"medianNs\": " << result.medianNs
+           << ", \"meanNs\": " << result.meanNs << ", \"maxNs\": " << result.maxNs << "}";
+  }
+
+  stream << "\n  ]\n}\n";
+}
+
+} // namespace cbl::bench
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cbl::bench {
+// Keeps the compiler from discarding a value whose computation is being measured
+template <typename T> inline void doNotOptimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static void const *volatile sink;
+  sink = &value;
+#endif
+}
+
+struct BenchmarkResult {
+  std::string name;
+  uint64_t iterations{}; // per sample
+  uint64_t itemsPerIteration{};
+  double minNs{};
+  double medianNs{};
+  double meanNs{};
+  double maxNs{};
+};
+
+struct BenchmarkRunner {
+private:
+  struct Benchmark {
+    std::string name;
+    uint64_t itemsPerIteration;
+    std::function<std::function<void()>()> setup;
+  };
+
+  std::vector<Benchmark> mBenchmarks{};
+
+  std::string mFilter{};
+  uint32_t mSamples = 15;
+  double mMinSampleMs = 20.0;
+
+  [[nodiscard]] uint64_t calibrate(std::function<void()> const &iteration) const;
+
+public:
+  BenchmarkRunner() = default;
+  // Parses --filter=<substring>, --samples=<n> and --min-sample-ms=<ms>
+  BenchmarkRunner(int const &argc, char const *const *argv);
+
+  // setup runs once, untimed, and returns the function whose calls are measured
+  void add(std::string const &name, uint64_t const &itemsPerIteration,
+           std::function<std::function<void()>()> setup);
+
+  [[nodiscard]] std::vector<BenchmarkResult> run() const;
+
+  static void writeTable(std::ostream &stream, std::vector<BenchmarkResult> const &results);
+  static void writeJson(std::ostream &stream, std::vector<BenchmarkResult> const &results,
+                        uint32_t const &seed);
+};
+} // namespace cbl::bench
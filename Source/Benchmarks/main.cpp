@@ -0,0 +1,245 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "External/PerlinNoise/PerlinNoise.hpp"
+
+#include "Benchmarks/BenchmarkRunner.hpp"
+#include "Game/Chunks/Chunk.hpp"
+#include "Game/Chunks/Generator/ChunkGenerator.hpp"
+#include "Game/Chunks/Generator/DensityField.hpp"
+#include "Game/Chunks/Generator/TerrainLayers.hpp"
+#include "Game/Chunks/Storage/MeshCache.hpp"
+#include "Game/Chunks/Storage/RegionFile.hpp"
+
+using namespace cbl;
+using namespace cbl::bench;
+
+namespace {
+constexpr uint64_t BlocksPerChunk = Chunk::BlocksX * Chunk::BlocksY * Chunk::BlocksZ;
+
+template <typename Visitor> void forEachBlock(Visitor const &visitor) {
+  for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+    for (unsigned int y = 0; y < Chunk::BlocksY; y++) {
+      for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+        visitor(x, y, z);
+      }
+    }
+  }
+}
+
+void addNoiseBenchmarks(BenchmarkRunner &runner) {
+  runner.add("noise/octave2d_3_chunk_column", Chunk::BlocksX * Chunk::BlocksZ, [] {
+    auto perlin = std::make_shared<siv::PerlinNoise>(BenchmarkSeed);
+
+    return [perlin]() {
+      for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+        for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+          doNotOptimize(perlin->accumulatedOctaveNoise2D_0_1(static_cast<double>(x) / 50.0,
+                                                             static_cast<double>(z) / 50.0, 3));
+        }
+      }
+    };
+  });
+
+  runner.add("noise/octave3d_3_chunk", BlocksPerChunk, [] {
+    auto perlin = std::make_shared<siv::PerlinNoise>(BenchmarkSeed);
+
+    return [perlin]() {
+      forEachBlock([&perlin](unsigned int x, unsigned int y, unsigned int z) {
+        doNotOptimize(perlin->accumulatedOctaveNoise3D_0_1(static_cast<double>(x) / 50.0,
+                                                           static_cast<double>(y) / 50.0,
+                                                           static_cast<double>(z) / 50.0, 3));
+      });
+    };
+  });
+
+  // 3D noise sampled every 4 blocks and interpolated, with the settings of the generator
+  runner.add("noise/density_field_chunk", BlocksPerChunk, [] {
+    auto perlin =
+        std::make_shared<siv::PerlinNoise>(BenchmarkSeed + ChunkGenerator::DensitySeedOffset);
+
+    return [perlin]() {
+      DensityField const density{*perlin, glm::vec3{0.0f}, ChunkGenerator::DensityFrequency,
+                                 ChunkGenerator::DensityOctaves};
+      float sum = 0.0f;
+      forEachBlock([&density, &sum](unsigned int x, unsigned int y, unsigned int z) {
+        sum += density.sample(x, y, z);
+      });
+      doNotOptimize(sum);
+    };
+  });
+}
+
+void addGenerationBenchmarks(BenchmarkRunner &runner) {
+  runner.add("generation/chunk", BlocksPerChunk, [] {
+    return []() { doNotOptimize(ChunkGenerator::generate(3, 5, BenchmarkSeed)); };
+  });
+
+  // climate, biome map and height shape of 4 x 4 chunks, computed once for all of them
+  runner.add("generation/layer_tile", 16 * BlocksPerChunk, [] {
+    return []() { doNotOptimize(LayerTile{0, 0, BenchmarkSeed}); };
+  });
+
+  // the layer tile comes from a cache, as when chunks are generated together
+  runner.add("generation/chunk_shared_layers", BlocksPerChunk, [] {
+    auto layers = std::make_shared<LayerTileCache>(BenchmarkSeed);
+
+    return [layers]() { doNotOptimize(ChunkGenerator::generate(3, 5, *layers)); };
+  });
+
+  // generation, neighbour linking and meshing of a whole area, as done at startup
+  runner.add("generation/many_8x8", 64 * BlocksPerChunk, [] {
+    return []() { doNotOptimize(ChunkGenerator::generateMany(8, 8, BenchmarkSeed)); };
+  });
+
+  runner.add("generation/many_8x8_jobs", 64 * BlocksPerChunk, [] {
+    auto scheduler = std::make_shared<jobs::Scheduler>();
+
+    return [scheduler]() {
+      doNotOptimize(ChunkGenerator::generateMany(8, 8, BenchmarkSeed, *scheduler));
+    };
+  });
+}
+
+void addMeshingBenchmarks(BenchmarkRunner &runner) {
+  // one entry per mesher variant, all meshing the center chunk of the same 3x3 area
+  runner.add("meshing/culled_faces", BlocksPerChunk, [] {
+    auto chunks = std::make_shared<std::map<std::pair<int, int>, Chunk>>(
+        ChunkGenerator::generateMany(3, 3, BenchmarkSeed));
+
+    return [chunks]() {
+      Chunk &chunk = chunks->at({1, 1});
+      chunk.rebuildMesh();
+      doNotOptimize(chunk.mesh);
+    };
+  });
+
+  // hashing the chunk and copying its mesh out of the cache file, instead of meshing it
+  runner.add("meshing/cache_hit", BlocksPerChunk, [] {
+    auto chunks = std::make_shared<std::map<std::pair<int, int>, Chunk>>(
+        ChunkGenerator::generateMany(3, 3, BenchmarkSeed));
+    Chunk const &center = chunks->at({1, 1});
+
+    std::filesystem::path const path =
+        std::filesystem::temp_directory_path() / "cobblestone_benchmark_meshes.bin";
+    std::filesystem::remove(path);
+    auto meshCache = std::make_shared<MeshCache>(path);
+    meshCache->store(1, 1, MeshCache::hash(center), center.mesh);
+    meshCache->save();
+
+    return [chunks, meshCache]() {
+      Chunk &chunk = chunks->at({1, 1});
+      bool const found = meshCache->find(1, 1, MeshCache::hash(chunk), chunk.mesh);
+      doNotOptimize(found);
+      doNotOptimize(chunk.mesh);
+    };
+  });
+
+  runner.add("meshing/culled_faces_no_neighbours", BlocksPerChunk, [] {
+    auto chunk = std::make_shared<Chunk>(ChunkGenerator::generate(1, 1, BenchmarkSeed));
+
+    return [chunk]() {
+      chunk->rebuildMesh();
+      doNotOptimize(chunk->mesh);
+    };
+  });
+}
+
+// loading a saved chunk decodes it instead of running generation/chunk
+void addStorageBenchmarks(BenchmarkRunner &runner) {
+  runner.add("storage/encode_chunk", BlocksPerChunk, [] {
+    auto chunk = std::make_shared<Chunk>(ChunkGenerator::generate(3, 5, BenchmarkSeed));
+
+    return [chunk]() { doNotOptimize(RegionFile::encode(*chunk)); };
+  });
+
+  runner.add("storage/decode_chunk", BlocksPerChunk, [] {
+    auto data = std::make_shared<std::vector<uint8_t>>(
+        RegionFile::encode(ChunkGenerator::generate(3, 5, BenchmarkSeed)));
+    auto chunk = std::make_shared<Chunk>();
+
+    return [data, chunk]() {
+      RegionFile::decode(data->data(), data->size(), *chunk);
+      doNotOptimize(chunk->blocks);
+    };
+  });
+}
+
+void addBlockAccessBenchmarks(BenchmarkRunner &runner) {
+  runner.add("blocks/read_xyz", BlocksPerChunk, [] {
+    auto chunk = std::make_shared<Chunk>(ChunkGenerator::generate(0, 0, BenchmarkSeed));
+
+    return [chunk]() {
+      unsigned int solidBlocks = 0;
+      forEachBlock([&](unsigned int x, unsigned int y, unsigned int z) {
+        solidBlocks += chunk->blocks[x][y][z] != Block::Type::eAir;
+      });
+      doNotOptimize(solidBlocks);
+    };
+  });
+
+  // walks the storage against its layout
+  runner.add("blocks/read_zyx", BlocksPerChunk, [] {
+    auto chunk = std::make_shared<Chunk>(ChunkGenerator::generate(0, 0, BenchmarkSeed));
+
+    return [chunk]() {
+      unsigned int solidBlocks = 0;
+      forEachBlock([&](unsigned int z, unsigned int y, unsigned int x) {
+        solidBlocks += chunk->blocks[x][y][z] != Block::Type::eAir;
+      });
+      doNotOptimize(solidBlocks);
+    };
+  });
+
+  runner.add("blocks/read_random", BlocksPerChunk, [] {
+    auto chunk = std::make_shared<Chunk>(ChunkGenerator::generate(0, 0, BenchmarkSeed));
+
+    std::mt19937 random{BenchmarkSeed};
+    auto coordinates = std::make_shared<std::vector<uint32_t>>(BlocksPerChunk);
+    for (uint32_t &coordinate : *coordinates) {
+      coordinate = random() % BlocksPerChunk;
+    }
+
+    return [chunk, coordinates]() {
+      unsigned int solidBlocks = 0;
+      for (uint32_t const &coordinate : *coordinates) {
+        uint32_t const x = coordinate / (Chunk::BlocksY * Chunk::BlocksZ);
+        uint32_t const y = coordinate / Chunk::BlocksZ % Chunk::BlocksY;
+        uint32_t const z = coordinate % Chunk::BlocksZ;
+        solidBlocks += chunk->blocks[x][y][z] != Block::Type::eAir;
+      }
+      doNotOptimize(solidBlocks);
+    };
+  });
+}
+} // namespace
+
+// Usage: cobblestone_benchmarks [--filter=<substring>] [--samples=<n>] [--min-sample-ms=<ms>]
+//                               [--output=<results.json>]
+int main(int argc, char *argv[]) {
+  BenchmarkRunner runner{argc, argv};
+
+  addNoiseBenchmarks(runner);
+  addGenerationBenchmarks(runner);
+  addMeshingBenchmarks(runner);
+  addStorageBenchmarks(runner);
+  addBlockAccessBenchmarks(runner);
+
+  std::vector<BenchmarkResult> const results = runner.run();
+  BenchmarkRunner::writeTable(std::cout, results);
+
+  for (int i = 1; i < argc; i++) {
+    std::string const argument{argv[i]};
+    if (argument.rfind("--output=", 0) == 0) {
+      std::ofstream output{argument.substr(std::string{"--output="}.size())};
+      BenchmarkRunner::writeJson(output, results, BenchmarkSeed);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cbl {
+
+MappedFile::MappedFile(std::filesystem::path const &path) {
+#ifdef _WIN32
+  HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to open " + path.string());
+  }
+  mFile = file;
+
+  LARGE_INTEGER fileSize{};
+  GetFileSizeEx(file, &fileSize);
+  mSize = static_cast<size_t>(fileSize.QuadPart);
+
+  // empty files cannot be mapped, they are left with a null data pointer
+  if (mSize > 0) {
+    mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping != nullptr) {
+      mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+    }
+
+    if (mData == nullptr) {
+      close();
+      throw std::runtime_error("Failed to map " + path.string());
+    }
+  }
+#else
+  int const file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error("Failed to open " + path.string());
+  }
+
+  struct stat fileStatus {};
+  if (fstat(file, &fileStatus) != 0) {
+    ::close(file);
+    throw std::runtime_error("Failed to read the size of " + path.string());
+  }
+  mSize = static_cast<size_t>(fileStatus.st_size);
+
+  // empty files cannot be mapped, they are left with a null data pointer
+  if (mSize > 0) {
+    void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+    if (data == MAP_FAILED) {
+      ::close(file);
+      throw std::runtime_error("Failed to map " + path.string());
+    }
+    mData = data;
+  }
+
+  // the mapping keeps its own reference to the file
+  ::close(file);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    mData = std::exchange(other.mData, nullptr);
+    mSize = std::exchange(other.mSize, 0);
+#ifdef _WIN32
+    mFile = std::exchange(other.mFile, nullptr);
+    mMapping = std::exchange(other.mMapping, nullptr);
+#endif
+  }
+
+  return *this;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+  if (mData != nullptr) {
+    UnmapViewOfFile(mData);
+  }
+  if (mMapping != nullptr) {
+    CloseHandle(mMapping);
+  }
+  if (mFile != nullptr) {
+    CloseHandle(mFile);
+  }
+  mFile = nullptr;
+  mMapping = nullptr;
+#else
+  if (mData != nullptr) {
+    munmap(mData, mSize);
+  }
+#endif
+  mData = nullptr;
+  mSize = 0;
+}
+
+void const *MappedFile::data() const { return mData; }
+
+size_t MappedFile::size() const { return mSize; }
+
+} // namespace cbl
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace cbl {
+// Read only view of a whole file mapped in memory. Pages are loaded by the OS when first touched,
+// so large files cost nothing until they are read
+struct MappedFile {
+private:
+  void *mData = nullptr;
+  size_t mSize = 0;
+#ifdef _WIN32
+  void *mFile = nullptr;
+  void *mMapping = nullptr;
+#endif
+
+  void close();
+
+public:
+  MappedFile() = default;
+  MappedFile(MappedFile const &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  // throws std::runtime_error when the file cannot be opened or mapped
+  explicit MappedFile(std::filesystem::path const &path);
+  ~MappedFile();
+
+  void operator=(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  [[nodiscard]] void const *data() const;
+  [[nodiscard]] size_t size() const;
+};
+} // namespace cbl
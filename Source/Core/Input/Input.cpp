@@ -4,11 +4,32 @@
 #include <stdexcept>
 
 namespace cbl {
+std::vector<SDL_Event> Input::mPendingEvents{};
 std::vector<SDL_Event> Input::mEvents{};
+std::mutex Input::mMutex{};
+std::optional<bool> Input::mRequestedCursorGrab{};
 
-void Input::updateEvents(std::vector<SDL_Event> const &events) { mEvents = events; }
+void Input::updateEvents(std::vector<SDL_Event> const &events) {
+  std::lock_guard<std::mutex> lock{mMutex};
+  mPendingEvents.insert(mPendingEvents.end(), events.begin(), events.end());
+
+  if (mRequestedCursorGrab) {
+    SDL_bool const grab = *mRequestedCursorGrab ? SDL_TRUE : SDL_FALSE;
+    SDL_SetRelativeMouseMode(grab);
+    SDL_CaptureMouse(grab);
+    mRequestedCursorGrab.reset();
+  }
+}
+
+void Input::consumeEvents() {
+  std::lock_guard<std::mutex> lock{mMutex};
+  mEvents.clear();
+  mEvents.swap(mPendingEvents);
+}
 
 bool Input::keyPressed(std::string const &keyName) {
+  // SDL updates this array while polling events, the simulation thread sees changes one poll late
+  // at worst
   Uint8 const *keyStates = SDL_GetKeyboardState(nullptr);
   const SDL_Scancode scanCode = SDL_GetScancodeFromName(keyName.c_str());
 
@@ -20,35 +41,41 @@ bool Input::keyPressed(std::string const &keyName) {
 }
 
 Vector2<int> Input::getMouseMovement() {
-  for (SDL_Event event : mEvents) {
+  std::lock_guard<std::mutex> lock{mMutex};
+  Vector2<int> movement{0, 0};
+
+  for (SDL_Event const &event : mEvents) {
     if (event.type == SDL_MOUSEMOTION) {
-      return Vector2<int>{event.motion.xrel, event.motion.yrel};
+      movement.x += event.motion.xrel;
+      movement.y += event.motion.yrel;
     }
   }
 
-  return Vector2<int>{0, 0};
+  return movement;
 }
 
 bool Input::mouseLeftClicked() {
+  std::lock_guard<std::mutex> lock{mMutex};
   return std::any_of(mEvents.begin(), mEvents.end(), [](SDL_Event e) {
     return e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_LEFT;
   });
 }
 
 bool Input::mouseRightClicked() {
+  std::lock_guard<std::mutex> lock{mMutex};
   return std::any_of(mEvents.begin(), mEvents.end(), [](SDL_Event e) {
     return e.type == SDL_MOUSEBUTTONDOWN && e.button.button == SDL_BUTTON_RIGHT;
   });
 }
 
 void Input::grabCursor() {
-  SDL_SetRelativeMouseMode(SDL_TRUE);
-  SDL_CaptureMouse(SDL_TRUE);
+  std::lock_guard<std::mutex> lock{mMutex};
+  mRequestedCursorGrab = true;
 }
 
 void Input::releaseCursor() {
-  SDL_SetRelativeMouseMode(SDL_FALSE);
-  SDL_CaptureMouse(SDL_FALSE);
+  std::lock_guard<std::mutex> lock{mMutex};
+  mRequestedCursorGrab = false;
 }
 
 } // namespace cbl
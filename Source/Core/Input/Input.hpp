@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -9,14 +11,28 @@
 #include "Math/Vector/Vector2/Vector2.hpp"
 
 namespace cbl {
+namespace gfx {
+struct Engine;
+}
+
 struct Input {
 private:
+  // events polled since the last simulation step, so that none are lost or seen twice when the
+  // frame rate and the simulation rate differ
+  static std::vector<SDL_Event> mPendingEvents;
+  // events seen by the queries during the current simulation step
   static std::vector<SDL_Event> mEvents;
+  // the simulation thread reads input while the main thread polls events
+  static std::mutex mMutex;
+  // SDL mouse modes can only be changed from the main thread, at the next event poll
+  static std::optional<bool> mRequestedCursorGrab;
 
   Input() = default;
 
   static void updateEvents(std::vector<SDL_Event> const &events);
+  static void consumeEvents();
   friend struct gfx::Window;
+  friend struct gfx::Engine;
 
 public:
   Input(Input const &) = delete;
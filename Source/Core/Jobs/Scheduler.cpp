@@ -0,0 +1,279 @@
+#include "Scheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "Core/Trace/Trace.hpp"
+
+namespace cbl::jobs {
+
+struct Task {
+  Job job;
+  Counter *counter;
+  Task *next; // next continuation of the same counter
+};
+
+namespace {
+thread_local Scheduler const *currentScheduler = nullptr;
+thread_local size_t currentWorkerIndex = 0;
+} // namespace
+
+bool Counter::isDone() const {
+  if (mPending.load(std::memory_order_acquire) != 0) {
+    return false;
+  }
+
+  // the job that brought the counter to zero may still be releasing its continuations, the
+  // counter has to stay alive until it is done
+  std::lock_guard<std::mutex> lock{mMutex};
+  return true;
+}
+
+uint32_t Scheduler::getDefaultWorkerCount() {
+  return std::max(std::thread::hardware_concurrency(), 2u) - 1;
+}
+
+Scheduler::Scheduler(uint32_t const &workerCount) : mMainThreadId{std::this_thread::get_id()} {
+  // without any worker, jobs that nobody waits on would never run
+  uint32_t const count = std::max(workerCount, 1u);
+
+  for (uint32_t i = 0; i < count; i++) {
+    auto worker = std::make_unique<Worker>();
+    worker->name = "Worker " + std::to_string(i);
+    mWorkers.push_back(std::move(worker));
+  }
+
+  // every deque has to exist before a worker starts stealing
+  for (size_t i = 0; i < mWorkers.size(); i++) {
+    mWorkers[i]->thread = std::thread{&Scheduler::workerLoop, this, i};
+  }
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> lock{mSleepMutex};
+    mStopping.store(true);
+  }
+  mWakeUp.notify_all();
+
+  // workers only exit once they cannot find anything left to run
+  for (std::unique_ptr<Worker> const &worker : mWorkers) {
+    worker->thread.join();
+  }
+
+  for (Task *task : mMainThreadTasks) {
+    delete task;
+  }
+}
+
+void Scheduler::workerLoop(size_t const &workerIndex) {
+  currentScheduler = this;
+  currentWorkerIndex = workerIndex;
+  CBL_TRACE_THREAD_NAME(mWorkers[workerIndex]->name.c_str());
+
+  while (true) {
+    uint64_t const epoch = mWakeEpoch.load(std::memory_order_acquire);
+
+    if (Task *task = findTask(workerIndex)) {
+      runTask(task);
+      continue;
+    }
+
+    if (mStopping.load()) {
+      return;
+    }
+
+    // anything submitted after the epoch was read bumps it, so no wake up can be missed
+    std::unique_lock<std::mutex> lock{mSleepMutex};
+    mWakeUp.wait(lock, [this, &epoch]() {
+      return mStopping.load() || mWakeEpoch.load(std::memory_order_relaxed) != epoch;
+    });
+  }
+}
+
+void Scheduler::submit(Task *task) {
+  if (currentScheduler == this && mWorkers[currentWorkerIndex]->deque.push(task)) {
+    wakeWorkers();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mInjectedMutex};
+    mInjectedTasks.push_back(task);
+  }
+  wakeWorkers();
+}
+
+void Scheduler::finish(Counter &counter) {
+  Task *continuation = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock{counter.mMutex};
+    if (counter.mPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      continuation = std::exchange(counter.mContinuations, nullptr);
+    }
+  }
+
+  while (continuation != nullptr) {
+    Task *next = continuation->next;
+    submit(continuation);
+    continuation = next;
+  }
+}
+
+void Scheduler::wakeWorkers() {
+  {
+    std::lock_guard<std::mutex> lock{mSleepMutex};
+    mWakeEpoch.fetch_add(1, std::memory_order_release);
+  }
+  mWakeUp.notify_one();
+}
+
+Task *Scheduler::findTask(size_t const &preferredWorker) {
+  if (currentScheduler == this) {
+    if (Task *task = mWorkers[currentWorkerIndex]->deque.pop()) {
+      return task;
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mInjectedMutex};
+    if (!mInjectedTasks.empty()) {
+      Task *task = mInjectedTasks.front();
+      mInjectedTasks.pop_front();
+      return task;
+    }
+  }
+
+  for (size_t i = 1; i <= mWorkers.size(); i++) {
+    if (Task *task = mWorkers[(preferredWorker + i) % mWorkers.size()]->deque.steal()) {
+      return task;
+    }
+  }
+
+  return nullptr;
+}
+
+void Scheduler::runTask(Task *task) {
+  {
+    CBL_TRACE_SCOPE("Job");
+    task->job();
+  }
+
+  Counter *counter = task->counter;
+  delete task;
+
+  if (counter != nullptr) {
+    finish(*counter);
+  }
+}
+
+bool Scheduler::runMainThreadTask() {
+  Task *task = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock{mMainThreadMutex};
+    if (mMainThreadTasks.empty()) {
+      return false;
+    }
+
+    task = mMainThreadTasks.front();
+    mMainThreadTasks.pop_front();
+  }
+
+  runTask(task);
+  return true;
+}
+
+void Scheduler::schedule(Job job, Counter *counter) {
+  if (counter != nullptr) {
+    counter->mPending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  submit(new Task{std::move(job), counter, nullptr});
+}
+
+void Scheduler::scheduleAfter(Counter &dependency, Job job, Counter *counter) {
+  if (counter != nullptr) {
+    counter->mPending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  auto *task = new Task{std::move(job), counter, nullptr};
+
+  {
+    std::lock_guard<std::mutex> lock{dependency.mMutex};
+    if (dependency.mPending.load(std::memory_order_acquire) != 0) {
+      task->next = dependency.mContinuations;
+      dependency.mContinuations = task;
+      return;
+    }
+  }
+
+  submit(task);
+}
+
+void Scheduler::scheduleOnMainThread(Job job, Counter *counter) {
+  if (counter != nullptr) {
+    counter->mPending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::lock_guard<std::mutex> lock{mMainThreadMutex};
+  mMainThreadTasks.push_back(new Task{std::move(job), counter, nullptr});
+}
+
+void Scheduler::runMainThreadJobs() {
+  CBL_TRACE_SCOPE("Scheduler::runMainThreadJobs");
+
+  // jobs scheduled by these jobs wait for the next call
+  std::deque<Task *> tasks{};
+  {
+    std::lock_guard<std::mutex> lock{mMainThreadMutex};
+    tasks.swap(mMainThreadTasks);
+  }
+
+  for (Task *task : tasks) {
+    runTask(task);
+  }
+}
+
+void Scheduler::wait(Counter const &counter) {
+  CBL_TRACE_SCOPE("Scheduler::wait");
+  size_t const preferredWorker = currentScheduler == this ? currentWorkerIndex : 0;
+
+  while (!counter.isDone()) {
+    if (isMainThread() && runMainThreadTask()) {
+      continue;
+    }
+
+    if (Task *task = findTask(preferredWorker)) {
+      runTask(task);
+      continue;
+    }
+
+    std::this_thread::yield();
+  }
+}
+
+void Scheduler::parallelFor(size_t const &count, size_t const &grainSize,
+                            std::function<void(size_t begin, size_t end)> const &body) {
+  if (count == 0) {
+    return;
+  }
+
+  size_t const rangeSize =
+      grainSize > 0 ? grainSize : std::max(count / ((mWorkers.size() + 1) * 4), size_t{1});
+
+  Counter counter{};
+  for (size_t begin = 0; begin < count; begin += rangeSize) {
+    size_t const end = std::min(begin + rangeSize, count);
+    schedule([&body, begin, end]() { body(begin, end); }, &counter);
+  }
+
+  wait(counter);
+}
+
+uint32_t Scheduler::getWorkerCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+bool Scheduler::isMainThread() const { return std::this_thread::get_id() == mMainThreadId; }
+
+} // namespace cbl::jobs
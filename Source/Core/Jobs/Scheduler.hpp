@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Core/Jobs/WorkStealingDeque.hpp"
+
+namespace cbl::jobs {
+using Job = std::function<void()>;
+
+struct Scheduler;
+struct Task;
+
+// Number of unfinished jobs scheduled against it. Jobs scheduled after a counter start once it
+// reaches zero, so all of its jobs must be scheduled first. A counter must outlive the jobs it
+// counts, and can be destroyed once isDone() returned true
+struct Counter {
+private:
+  Task *mContinuations = nullptr; // guarded by mMutex
+  std::atomic<uint32_t> mPending{0};
+  mutable std::mutex mMutex{};
+
+  friend struct Scheduler;
+
+public:
+  Counter() = default;
+  Counter(Counter const &) = delete;
+
+  void operator=(Counter const &) = delete;
+
+  [[nodiscard]] bool isDone() const;
+};
+
+struct Scheduler {
+private:
+  struct Worker {
+    WorkStealingDeque<Task> deque{};
+    std::thread thread{};
+    std::string name{};
+  };
+
+  std::vector<std::unique_ptr<Worker>> mWorkers{};
+  std::thread::id mMainThreadId;
+
+  // jobs scheduled from threads that are not workers
+  std::mutex mInjectedMutex{};
+  std::deque<Task *> mInjectedTasks{};
+
+  std::mutex mMainThreadMutex{};
+  std::deque<Task *> mMainThreadTasks{};
+
+  // sleeping workers wake up whenever the epoch changes
+  std::mutex mSleepMutex{};
+  std::condition_variable mWakeUp{};
+  std::atomic<uint64_t> mWakeEpoch{0};
+  std::atomic<bool> mStopping{false};
+
+  void workerLoop(size_t const &workerIndex);
+
+  void submit(Task *task);
+  void finish(Counter &counter);
+  void wakeWorkers();
+  [[nodiscard]] Task *findTask(size_t const &preferredWorker);
+  void runTask(Task *task);
+  bool runMainThreadTask();
+
+public:
+  // one worker less than the hardware threads, the main thread is busy rendering
+  [[nodiscard]] static uint32_t getDefaultWorkerCount();
+
+  // The thread constructing the scheduler is its main thread
+  explicit Scheduler(uint32_t const &workerCount = getDefaultWorkerCount());
+  Scheduler(Scheduler const &) = delete;
+  ~Scheduler();
+
+  void operator=(Scheduler const &) = delete;
+
+  // Jobs run on any worker, or on a thread waiting for a counter. They must not throw
+  void schedule(Job job, Counter *counter = nullptr);
+  // Runs job once dependency reaches zero
+  void scheduleAfter(Counter &dependency, Job job, Counter *counter = nullptr);
+  // For work that has to happen on the main thread, such as Vulkan queue submission. Runs during
+  // runMainThreadJobs, or while the main thread waits for a counter
+  void scheduleOnMainThread(Job job, Counter *counter = nullptr);
+  void runMainThreadJobs();
+
+  // Runs other jobs while waiting, so it can be called from jobs without deadlocking the pool
+  void wait(Counter const &counter);
+
+  // Splits [0, count) in ranges of at most grainSize and runs body on them in parallel. Returns
+  // once every range is done. A grainSize of 0 picks one that gives each worker a few ranges
+  void parallelFor(size_t const &count, size_t const &grainSize,
+                   std::function<void(size_t begin, size_t end)> const &body);
+
+  [[nodiscard]] uint32_t getWorkerCount() const;
+  [[nodiscard]] bool isMainThread() const;
+};
+} // namespace cbl::jobs
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace cbl::jobs {
+// Chase-Lev deque with a fixed capacity ("Correct and Efficient Work-Stealing for Weak Memory
+// Models", Lê et al. 2013). Only the owning thread may push and pop, at the bottom. Any thread may
+// steal, from the top
+template <typename T> struct WorkStealingDeque {
+private:
+  static constexpr int64_t mCapacity = 1 << 12;
+  static constexpr int64_t mMask = mCapacity - 1;
+
+  std::array<std::atomic<T *>, mCapacity> mItems{};
+  alignas(64) std::atomic<int64_t> mTop{0};
+  alignas(64) std::atomic<int64_t> mBottom{0};
+
+public:
+  WorkStealingDeque() = default;
+  WorkStealingDeque(WorkStealingDeque const &) = delete;
+
+  void operator=(WorkStealingDeque const &) = delete;
+
+  // false when the deque is full, the item was not added
+  [[nodiscard]] bool push(T *item) {
+    int64_t const bottom = mBottom.load(std::memory_order_relaxed);
+    int64_t const top = mTop.load(std::memory_order_acquire);
+
+    if (bottom - top >= mCapacity) {
+      return false;
+    }
+
+    mItems[bottom & mMask].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    mBottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // newest item, or nullptr when empty
+  [[nodiscard]] T *pop() {
+    int64_t const bottom = mBottom.load(std::memory_order_relaxed) - 1;
+    mBottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = mTop.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T *item = mItems[bottom & mMask].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // last item, race the thieves for it
+      if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      mBottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    return item;
+  }
+
+  // oldest item, or nullptr when empty or when another thread won the race for it
+  [[nodiscard]] T *steal() {
+    int64_t top = mTop.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t const bottom = mBottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    T *item = mItems[top & mMask].load(std::memory_order_relaxed);
+    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+
+    return item;
+  }
+};
+} // namespace cbl::jobs
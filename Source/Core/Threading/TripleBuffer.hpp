@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace cbl {
+// Lock free handoff from one writer thread to one reader thread. The writer fills the back slot and
+// publishes it, the reader always gets the newest published slot. Neither side ever waits, and
+// slots are reused so their allocations survive from one publish to the next
+template <typename T> struct TripleBuffer {
+private:
+  static constexpr uint8_t mIndexMask = 0b011;
+  static constexpr uint8_t mFreshBit = 0b100;
+
+  std::array<T, 3> mSlots{};
+  std::atomic<uint8_t> mMiddle{1};
+  uint8_t mBack = 0;  // owned by the writer
+  uint8_t mFront = 2; // owned by the reader
+
+public:
+  TripleBuffer() = default;
+  TripleBuffer(TripleBuffer const &) = delete;
+
+  void operator=(TripleBuffer const &) = delete;
+
+  // writer side, holds stale data from an earlier publish
+  [[nodiscard]] T &getWriteSlot() { return mSlots[mBack]; }
+
+  void publish() {
+    mBack = mMiddle.exchange(mBack | mFreshBit, std::memory_order_acq_rel) & mIndexMask;
+  }
+
+  // reader side, the returned value stays valid until the next call
+  [[nodiscard]] T const &read() {
+    if (mMiddle.load(std::memory_order_relaxed) & mFreshBit) {
+      mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & mIndexMask;
+    }
+
+    return mSlots[mFront];
+  }
+};
+} // namespace cbl
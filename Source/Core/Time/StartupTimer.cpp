@@ -0,0 +1,47 @@
+#include "StartupTimer.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+namespace cbl {
+StartupTimer::Clock::time_point const StartupTimer::mProgramStart = StartupTimer::Clock::now();
+std::mutex StartupTimer::mMutex{};
+std::vector<StartupTimer::Entry> StartupTimer::mEntries{};
+std::atomic<bool> StartupTimer::mReported{false};
+
+StartupTimer::Phase::Phase(std::string name) : mName{std::move(name)}, mStart{now()} {}
+
+StartupTimer::Phase::~Phase() { record(std::move(mName), mStart); }
+
+StartupTimer::Clock::time_point StartupTimer::now() { return Clock::now(); }
+
+void StartupTimer::record(std::string name, Clock::time_point const &start,
+                          Clock::time_point const &end) {
+  std::lock_guard<std::mutex> lock{mMutex};
+  mEntries.push_back({std::move(name), start, end});
+}
+
+void StartupTimer::reportFirstFrame(std::ostream &output) {
+  if (mReported.exchange(true)) {
+    return;
+  }
+
+  Clock::time_point const firstFrame = now();
+  auto const toMs = [](Clock::duration const &duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  };
+
+  std::lock_guard<std::mutex> lock{mMutex};
+  std::sort(mEntries.begin(), mEntries.end(),
+            [](Entry const &a, Entry const &b) { return a.start < b.start; });
+
+  output << "Startup phases (start ms, duration ms):\n" << std::fixed << std::setprecision(1);
+  for (Entry const &entry : mEntries) {
+    output << "  " << std::setw(8) << toMs(entry.start - mProgramStart) << std::setw(9)
+           << toMs(entry.end - entry.start) << "  " << entry.name << '\n';
+  }
+  output << "Time to first frame: " << toMs(firstFrame - mProgramStart) << " ms\n"
+         << std::defaultfloat;
+}
+} // namespace cbl
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace cbl {
+// Wall clock duration of the startup phases, printed once the first frame is rendered. Phases can
+// run on any thread and overlap, each one is reported with its start time since the program started
+struct StartupTimer {
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::string name;
+    Clock::time_point start;
+    Clock::time_point end;
+  };
+
+  static Clock::time_point const mProgramStart;
+  static std::mutex mMutex;
+  static std::vector<Entry> mEntries;
+  static std::atomic<bool> mReported;
+
+public:
+  // times the enclosing scope
+  struct Phase {
+  private:
+    std::string mName;
+    Clock::time_point mStart;
+
+  public:
+    Phase() = delete;
+    Phase(Phase const &) = delete;
+    explicit Phase(std::string name);
+    ~Phase();
+
+    void operator=(Phase const &) = delete;
+  };
+
+  StartupTimer() = delete;
+  StartupTimer(StartupTimer const &) = delete;
+  ~StartupTimer() = delete;
+
+  [[nodiscard]] static Clock::time_point now();
+  static void record(std::string name, Clock::time_point const &start,
+                     Clock::time_point const &end = now());
+
+  // Only the first call writes anything, the following ones return immediately
+  static void reportFirstFrame(std::ostream &output);
+};
+} // namespace cbl
@@ -1,17 +1,66 @@
 #include "Time.hpp"
 
-#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 
 namespace cbl {
 
-uint32_t Time::mLastTick = 0;
+Time::Clock::time_point Time::mLastTick{};
 float Time::mDeltaSeconds = 0.0f;
+float Time::mSmoothedDeltaSeconds = 0.0f;
+
+std::array<float, Time::mFrameHistorySize> Time::mFrameHistory{};
+size_t Time::mFrameCount = 0;
 
 void Time::tick() {
-  uint32_t tickTime = SDL_GetTicks();
-  mDeltaSeconds = static_cast<float>(tickTime - mLastTick) / 1000;
+  Clock::time_point const tickTime = Clock::now();
+
+  if (mLastTick == Clock::time_point{}) {
+    mLastTick = tickTime;
+    return;
+  }
+
+  mDeltaSeconds = std::chrono::duration<float>(tickTime - mLastTick).count();
   mLastTick = tickTime;
+
+  if (mFrameCount == 0) {
+    mSmoothedDeltaSeconds = mDeltaSeconds;
+  } else {
+    mSmoothedDeltaSeconds += (mDeltaSeconds - mSmoothedDeltaSeconds) * mSmoothingFactor;
+  }
+  mFrameHistory[mFrameCount % mFrameHistorySize] = mDeltaSeconds;
+  mFrameCount++;
 }
 
 float Time::deltaSeconds() { return mDeltaSeconds; }
-} // namespace flex
\ No newline at end of file
+
+float Time::fixedDeltaSeconds() { return FixedDeltaSeconds; }
+
+float Time::smoothedDeltaSeconds() { return mSmoothedDeltaSeconds; }
+
+FrameTimeStatistics Time::getFrameStatistics() {
+  size_t const frameCount = std::min(mFrameCount, mFrameHistorySize);
+  if (frameCount == 0) {
+    return FrameTimeStatistics{};
+  }
+
+  auto const frames = mFrameHistory.begin();
+  float const sum = std::accumulate(frames, frames + frameCount, 0.0f);
+  float const average = sum / static_cast<float>(frameCount);
+
+  float variance = 0.0f;
+  for (size_t i = 0; i < frameCount; i++) {
+    variance += (mFrameHistory[i] - average) * (mFrameHistory[i] - average);
+  }
+  variance /= static_cast<float>(frameCount);
+
+  FrameTimeStatistics statistics{};
+  statistics.averageMs = average * 1000.0f;
+  statistics.minMs = *std::min_element(frames, frames + frameCount) * 1000.0f;
+  statistics.maxMs = *std::max_element(frames, frames + frameCount) * 1000.0f;
+  statistics.standardDeviationMs = std::sqrt(variance) * 1000.0f;
+
+  return statistics;
+}
+} // namespace flex
@@ -1,24 +1,51 @@
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <cstdint>
 
 #include "Graphics/Engine/Engine.hpp"
 
 namespace cbl {
+struct FrameTimeStatistics {
+  float averageMs;
+  float minMs;
+  float maxMs;
+  float standardDeviationMs;
+};
+
 struct Time {
 private:
-  static uint32_t mLastTick;
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr float mSmoothingFactor = 0.05f;
+  static constexpr size_t mFrameHistorySize = 240;
+
+  static Clock::time_point mLastTick;
   static float mDeltaSeconds;
+  static float mSmoothedDeltaSeconds;
+
+  static std::array<float, mFrameHistorySize> mFrameHistory;
+  static size_t mFrameCount;
 
   static void tick();
   friend struct gfx::Engine;
 
 public:
+  static constexpr float FixedDeltaSeconds = 1.0f / 60.0f;
+
   Time() = delete;
   Time(Time &) = delete;
   Time(Time const &) = delete;
   ~Time() = delete;
 
+  // time between the last two rendered frames
   static float deltaSeconds();
+  // duration of a simulation step, to be used by everything updated from World::update
+  static float fixedDeltaSeconds();
+  static float smoothedDeltaSeconds();
+
+  // over the last mFrameHistorySize frames
+  [[nodiscard]] static FrameTimeStatistics getFrameStatistics();
 };
-} // namespace cbl
\ No newline at end of file
+} // namespace cbl
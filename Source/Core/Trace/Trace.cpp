@@ -0,0 +1,203 @@
+#include "Trace.hpp"
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cbl {
+
+namespace {
+struct TraceEvent {
+  char const *name;
+  uint64_t startNs;
+  uint64_t endNs;
+};
+
+// written only by its owning thread and read only by the thread driving the capture, so the
+// indices are the only synchronisation needed. The name is guarded by the registry mutex
+struct ThreadBuffer {
+  static constexpr size_t Capacity = 1u << 14u;
+
+  std::array<TraceEvent, Capacity> events{};
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+  std::atomic<uint64_t> droppedEvents{0};
+  std::string name{};
+  uint32_t threadId{};
+};
+
+struct ThreadRegistry {
+  std::mutex mutex{};
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+  uint32_t nextThreadId = 1;
+};
+
+struct Capture {
+  uint32_t framesRemaining = 0;
+  std::filesystem::path outputPath{};
+  std::vector<std::pair<uint32_t, TraceEvent>> events{};
+};
+
+ThreadRegistry &getThreadRegistry() {
+  static ThreadRegistry registry{};
+  return registry;
+}
+
+Capture &getCapture() {
+  static Capture capture{};
+  return capture;
+}
+
+ThreadBuffer &getThreadBuffer() {
+  // the registry shares ownership so that events of exited threads can still be exported
+  thread_local std::shared_ptr<ThreadBuffer> const buffer = [] {
+    auto threadBuffer = std::make_shared<ThreadBuffer>();
+
+    ThreadRegistry &registry = getThreadRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex};
+    threadBuffer->threadId = registry.nextThreadId++;
+    registry.buffers.push_back(threadBuffer);
+
+    return threadBuffer;
+  }();
+
+  return *buffer;
+}
+
+void drainThreadBuffers(Capture &capture) {
+  ThreadRegistry &registry = getThreadRegistry();
+  std::lock_guard<std::mutex> lock{registry.mutex};
+
+  for (std::shared_ptr<ThreadBuffer> const &buffer : registry.buffers) {
+    size_t const tail = buffer->tail.load(std::memory_order_relaxed);
+    size_t const head = buffer->head.load(std::memory_order_acquire);
+
+    for (size_t i = tail; i < head; i++) {
+      capture.events.emplace_back(buffer->threadId,
+                                  buffer->events[i & (ThreadBuffer::Capacity - 1)]);
+    }
+
+    buffer->tail.store(head, std::memory_order_release);
+  }
+}
+
+void writeChromeTrace(Capture const &capture) {
+  std::ofstream stream{capture.outputPath};
+  stream << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  auto const separator = [&first]() -> char const * {
+    char const *value = first ? "\n" : ",\n";
+    first = false;
+    return value;
+  };
+
+  {
+    ThreadRegistry &registry = getThreadRegistry();
+    std::lock_guard<std::mutex> lock{registry.mutex};
+
+    for (std::shared_ptr<ThreadBuffer> const &buffer : registry.buffers) {
+      std::string const threadName =
+          !buffer->name.empty() ? buffer->name : "Thread " + std::to_string(buffer->threadId);
+
+      stream << separator() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+             << buffer->threadId << R"(,"args":{"name":")" << threadName << R"(","dropped":)"
+             << buffer->droppedEvents.exchange(0, std::memory_order_relaxed) << "}}";
+    }
+  }
+
+  // chrome expects microseconds, keep the sub-microsecond part as a fraction
+  for (auto const &[threadId, event] : capture.events) {
+    stream << separator() << R"({"name":")" << event.name << R"(","ph":"X","pid":1,"tid":)"
+           << threadId << R"(,"ts":)" << static_cast<double>(event.startNs) / 1000.0
+           << R"(,"dur":)" << static_cast<double>(event.endNs - event.startNs) / 1000.0 << "}";
+  }
+
+  stream << "\n]}\n";
+}
+} // namespace
+
+std::atomic<bool> Trace::mCapturing{false};
+
+uint64_t Trace::nowNs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+bool Trace::isCapturing() { return mCapturing.load(std::memory_order_relaxed); }
+
+void Trace::record(char const *name, uint64_t const &startNs, uint64_t const &endNs) {
+  ThreadBuffer &buffer = getThreadBuffer();
+
+  size_t const head = buffer.head.load(std::memory_order_relaxed);
+  if (head - buffer.tail.load(std::memory_order_acquire) >= ThreadBuffer::Capacity) {
+    // never block the traced thread, the consumer catches up at the next frame boundary
+    buffer.droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer.events[head & (ThreadBuffer::Capacity - 1)] = TraceEvent{name, startNs, endNs};
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::captureFrames(uint32_t const &frameCount, std::filesystem::path const &outputPath) {
+  if (isCapturing() || frameCount == 0) {
+    return;
+  }
+
+  Capture &capture = getCapture();
+  capture.framesRemaining = frameCount;
+  capture.outputPath = outputPath;
+  capture.events.clear();
+
+  // discard whatever was left over from a previous capture
+  drainThreadBuffers(capture);
+  capture.events.clear();
+
+  mCapturing.store(true, std::memory_order_relaxed);
+}
+
+void Trace::frame() {
+  if (!isCapturing()) {
+    return;
+  }
+
+  Capture &capture = getCapture();
+  drainThreadBuffers(capture);
+
+  if (--capture.framesRemaining > 0) {
+    return;
+  }
+
+  mCapturing.store(false, std::memory_order_relaxed);
+  drainThreadBuffers(capture);
+  writeChromeTrace(capture);
+  capture.events.clear();
+}
+
+void Trace::setThreadName(std::string name) {
+  ThreadBuffer &buffer = getThreadBuffer();
+
+  ThreadRegistry &registry = getThreadRegistry();
+  std::lock_guard<std::mutex> lock{registry.mutex};
+  buffer.name = std::move(name);
+}
+
+TraceScope::TraceScope(char const *name)
+    : mName{name}, mStartNs{Trace::isCapturing() ? Trace::nowNs() : 0} {}
+
+TraceScope::~TraceScope() {
+  // scopes that started before the capture would show up truncated, skip them
+  if (mStartNs != 0 && Trace::isCapturing()) {
+    Trace::record(mName, mStartNs, Trace::nowNs());
+  }
+}
+
+} // namespace cbl
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// CBL_TRACE_SCOPE("name") times the enclosing scope on the calling thread. Names must be string
+// literals, since only the pointer is stored. Without CBL_ENABLE_TRACING (the COBBLESTONE_TRACING
+// CMake option), every macro expands to nothing. Thread names are copied, so any string works.
+#ifdef CBL_ENABLE_TRACING
+#define CBL_TRACE_CONCAT_IMPL(a, b) a##b
+#define CBL_TRACE_CONCAT(a, b) CBL_TRACE_CONCAT_IMPL(a, b)
+#define CBL_TRACE_SCOPE(name) ::cbl::TraceScope CBL_TRACE_CONCAT(cblTraceScope, __LINE__){name}
+#define CBL_TRACE_FRAME() ::cbl::Trace::frame()
+#define CBL_TRACE_THREAD_NAME(name) ::cbl::Trace::setThreadName(name)
+#else
+#define CBL_TRACE_SCOPE(name)
+#define CBL_TRACE_FRAME()
+#define CBL_TRACE_THREAD_NAME(name)
+#endif
+
+namespace cbl {
+struct Trace {
+private:
+  static std::atomic<bool> mCapturing;
+
+  static void record(char const *name, uint64_t const &startNs, uint64_t const &endNs);
+  friend struct TraceScope;
+
+public:
+  Trace() = delete;
+  Trace(Trace const &) = delete;
+  ~Trace() = delete;
+
+  [[nodiscard]] static uint64_t nowNs();
+  [[nodiscard]] static bool isCapturing();
+
+  // Records every scope of the next frameCount frames, then writes them to outputPath as Chrome
+  // trace_event JSON (chrome://tracing, ui.perfetto.dev)
+  static void captureFrames(uint32_t const &frameCount,
+                            std::filesystem::path const &outputPath = "cpu_trace.json");
+  // Marks a frame boundary. Must be called from the thread that started the capture
+  static void frame();
+
+  static void setThreadName(std::string name);
+};
+
+struct TraceScope {
+private:
+  char const *mName;
+  uint64_t mStartNs;
+
+public:
+  TraceScope() = delete;
+  TraceScope(TraceScope const &) = delete;
+  explicit TraceScope(char const *name);
+  ~TraceScope();
+
+  void operator=(TraceScope const &) = delete;
+};
+} // namespace cbl
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "Graphics/Camera/Camera.hpp"
+
+namespace cbl {
+// Everything the renderer needs from one simulation step. The renderer never reads the world
+// state the simulation thread is updating, only the newest published snapshot
+struct RenderSnapshot {
+  std::chrono::steady_clock::time_point stepTime{};
+  gfx::Camera camera{};
+  std::vector<size_t> drawList{}; // indices into World::meshes, culled by the renderer
+};
+} // namespace cbl
@@ -13,6 +13,12 @@ namespace gfx {
 struct Engine;
 }
 
+// filled by the game, the engine only reports them
+struct ChunkStats {
+  size_t chunkCount{};
+  size_t blockStorageBytes{};
+};
+
 struct World {
 private:
   void update();
@@ -24,5 +30,6 @@ public:
   std::vector<gfx::Mesh> meshes;
   std::vector<gfx::BaseShader *> shaders;
   std::vector<gfx::BaseMaterial *> materials;
+  ChunkStats chunkStats{};
 };
 } // namespace cbl
\ No newline at end of file
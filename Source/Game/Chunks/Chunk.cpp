@@ -1,5 +1,7 @@
 #include "Chunk.hpp"
 
+#include "Core/Trace/Trace.hpp"
+
 namespace cbl {
 
 void Chunk::addSideToMesh(
@@ -24,6 +26,7 @@ void Chunk::addSideToMesh(
 }
 
 void Chunk::rebuildMesh() {
+  CBL_TRACE_SCOPE("Chunk::rebuildMesh");
   mesh.indices.clear();
   mesh.vertices.clear();
 
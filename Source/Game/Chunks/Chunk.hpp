@@ -2,9 +2,10 @@
 
 #include <array>
 
-#include "Core/World/World.hpp"
+#include <glm/glm.hpp>
+
 #include "Game/Block/Block.hpp"
-#include "Graphics/Mesh/Mesh.hpp"
+#include "Game/Chunks/ChunkMesh.hpp"
 
 namespace cbl {
 struct Chunk {
@@ -19,7 +20,7 @@ public:
 
   std::array<std::array<std::array<Block::Type, BlocksZ>, BlocksY>, BlocksX> blocks{
       Block::Type::eAir};
-  gfx::Mesh mesh{{}, {}};
+  ChunkMesh mesh{};
   glm::vec3 position{0};
 
   Chunk *neighbourXPlus{nullptr};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/Vertex/Vertex.hpp"
+
+namespace cbl {
+// CPU side mesh data of a chunk, in chunk local coordinates. Turned into a gfx::Mesh by the
+// renderer, so that the world code stays free of any graphics API
+struct ChunkMesh {
+  std::vector<uint32_t> indices{};
+  std::vector<gfx::Vertex> vertices{};
+};
+} // namespace cbl
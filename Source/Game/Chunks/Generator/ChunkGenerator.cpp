@@ -1,35 +1,75 @@
 #include "ChunkGenerator.hpp"
 
-#include <ctime>
-
-#include <glm/gtc/matrix_transform.hpp>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
 
 #include "External/PerlinNoise/PerlinNoise.hpp"
 
+#include "Core/Trace/Trace.hpp"
+#include "Game/Chunks/Generator/DensityField.hpp"
+
 namespace cbl {
 
-Chunk ChunkGenerator::generate(int const &posX, int const &posZ) {
+namespace {
+// octave noise rarely strays far from 0.5, it has to be scaled up to ever beat the height
+constexpr float DensityStrength = 32.0f;
+
+void rebuildMesh(int const &, int const &, Chunk &chunk) { chunk.rebuildMesh(); }
+} // namespace
+
+Chunk ChunkGenerator::generate(int const &posX, int const &posZ, uint32_t const &seed,
+                               LayerTile const &layers) {
+  CBL_TRACE_SCOPE("ChunkGenerator::generate");
   Chunk chunk{};
   chunk.position = glm::vec3{posX * Chunk::BlocksX, 0.0f, posZ * Chunk::BlocksZ};
-  chunk.mesh.position = glm::translate(glm::mat4{1.0f}, chunk.position);
 
-  siv::PerlinNoise perlin(std::time(nullptr));
+  siv::PerlinNoise perlin(seed);
   double frequency = 50.0f;
 
-  for (int x = 0; x < Chunk::BlocksX; x++) {
-    for (int y = 0; y < Chunk::BlocksY; y++) {
-      for (int z = 0; z < Chunk::BlocksZ; z++) {
-        double noiseValue = perlin.accumulatedOctaveNoise2D_0_1(
-            static_cast<double>(x + static_cast<int>(chunk.position.x)) / frequency,
-            static_cast<double>(z + static_cast<int>(chunk.position.z)) / frequency, 3);
-        int adjustedNoiseValue = floor(noiseValue * Chunk::BlocksY);
-
-        if (y > adjustedNoiseValue) {
-          chunk.blocks[x][y][z] = Block::Type::eAir;
-        } else if (y == adjustedNoiseValue) {
+  // the height only depends on the column, the layer tile gives its shape and the chunk its
+  // detail
+  std::array<std::array<float, Chunk::BlocksZ>, Chunk::BlocksX> heights{};
+  for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+    for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+      double noiseValue = perlin.accumulatedOctaveNoise2D_0_1(
+          static_cast<double>(x + static_cast<int>(chunk.position.x)) / frequency,
+          static_cast<double>(z + static_cast<int>(chunk.position.z)) / frequency, 3);
+      TerrainColumn const &column = layers.getColumn(posX, posZ, x, z);
+      heights[x][z] = std::floor(column.baseHeight + (static_cast<float>(noiseValue) - 0.5f) *
+                                                         column.heightVariance * Chunk::BlocksY);
+    }
+  }
+
+  // moves the surface up or down, differently at every height, which carves caves below it and
+  // leaves overhangs above it
+  DensityField const density{siv::PerlinNoise{seed + DensitySeedOffset}, chunk.position,
+                             DensityFrequency, DensityOctaves};
+
+  for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+    for (unsigned int y = 0; y < Chunk::BlocksY; y++) {
+      for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+        float const offset = (density.sample(x, y, z) - 0.5f) * DensityStrength;
+        bool const solid = y == 0 || static_cast<float>(y) <= heights[x][z] + offset;
+        chunk.blocks[x][y][z] = solid ? Block::Type::eDirt : Block::Type::eAir;
+      }
+    }
+  }
+
+  // Every solid block with air right above it is grass, cave floors and overhangs included.
+  // Barren land is left as bare dirt
+  for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+    for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+      if (layers.getColumn(posX, posZ, x, z).biome == Biome::eBarren) {
+        continue;
+      }
+
+      for (unsigned int y = 0; y < Chunk::BlocksY; y++) {
+        bool const covered =
+            y + 1 < Chunk::BlocksY && chunk.blocks[x][y + 1][z] != Block::Type::eAir;
+        if (chunk.blocks[x][y][z] != Block::Type::eAir && !covered) {
           chunk.blocks[x][y][z] = Block::Type::eGrass;
-        } else {
-          chunk.blocks[x][y][z] = Block::Type::eDirt;
         }
       }
     }
@@ -38,16 +78,92 @@ Chunk ChunkGenerator::generate(int const &posX, int const &posZ) {
   return chunk;
 }
 
-std::map<std::pair<int, int>, Chunk> ChunkGenerator::generateMany(int const &numX,
-                                                                  int const &numZ) {
+Chunk ChunkGenerator::generate(int const &posX, int const &posZ, uint32_t const &seed) {
+  return generate(posX, posZ, seed, LayerTile::forChunk(posX, posZ, seed));
+}
+
+Chunk ChunkGenerator::generate(int const &posX, int const &posZ, LayerTileCache &layers) {
+  return generate(posX, posZ, layers.getSeed(), *layers.get(posX, posZ));
+}
+
+std::map<std::pair<int, int>, Chunk>
+ChunkGenerator::generateMany(int const &numX, int const &numZ, uint32_t const &seed) {
+  auto const serial = [](size_t const &count, RangeBody const &body) { body(0, count); };
+  LayerTileCache layers{seed};
+  auto const source = [&layers](int const &posX, int const &posZ) {
+    return generate(posX, posZ, layers);
+  };
+  return generateMany(numX, numZ, source, rebuildMesh, serial);
+}
+
+std::map<std::pair<int, int>, Chunk>
+ChunkGenerator::generateMany(int const &numX, int const &numZ, uint32_t const &seed,
+                             jobs::Scheduler &scheduler) {
+  // one job per chunk, they are large enough on their own
+  auto const parallel = [&scheduler](size_t const &count, RangeBody const &body) {
+    scheduler.parallelFor(count, 1, body);
+  };
+  LayerTileCache layers{seed};
+  auto const source = [&layers](int const &posX, int const &posZ) {
+    return generate(posX, posZ, layers);
+  };
+  return generateMany(numX, numZ, source, rebuildMesh, parallel);
+}
+
+std::map<std::pair<int, int>, Chunk>
+ChunkGenerator::generateMany(int const &numX, int const &numZ, uint32_t const &seed,
+                             jobs::Scheduler &scheduler, ChunkStore &store,
+                             MeshCache *meshCache) {
+  auto const parallel = [&scheduler](size_t const &count, RangeBody const &body) {
+    scheduler.parallelFor(count, 1, body);
+  };
+  LayerTileCache layers{seed};
+  auto const source = [&layers, &store](int const &posX, int const &posZ) {
+    Chunk chunk{};
+    if (store.load(posX, posZ, chunk)) {
+      return chunk;
+    }
+
+    chunk = generate(posX, posZ, layers);
+    store.save(posX, posZ, chunk);
+    return chunk;
+  };
+  auto const mesher = [meshCache](int const &posX, int const &posZ, Chunk &chunk) {
+    if (meshCache == nullptr) {
+      chunk.rebuildMesh();
+      return;
+    }
+
+    uint64_t const hash = MeshCache::hash(chunk);
+    if (!meshCache->find(posX, posZ, hash, chunk.mesh)) {
+      chunk.rebuildMesh();
+      meshCache->store(posX, posZ, hash, chunk.mesh);
+    }
+  };
+  return generateMany(numX, numZ, source, mesher, parallel);
+}
+
+std::map<std::pair<int, int>, Chunk>
+ChunkGenerator::generateMany(int const &numX, int const &numZ, ChunkSource const &source,
+                             ChunkMesher const &mesher, ForEachRange const &forEachRange) {
+  CBL_TRACE_SCOPE("ChunkGenerator::generateMany");
   std::map<std::pair<int, int>, Chunk> chunks{};
 
+  // the map is only modified here, every chunk is then filled in place
+  std::vector<std::pair<std::pair<int, int>, Chunk *>> chunkSlots{};
   for (int x = 0; x < numX; x++) {
     for (int z = 0; z < numZ; z++) {
-      chunks[std::make_pair(x, z)] = generate(x, z);
+      chunkSlots.emplace_back(std::make_pair(x, z), &chunks[std::make_pair(x, z)]);
     }
   }
 
+  forEachRange(chunkSlots.size(), [&chunkSlots, &source](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      auto const &[position, chunk] = chunkSlots[i];
+      *chunk = source(position.first, position.second);
+    }
+  });
+
   for (int x = 0; x < numX; x++) {
     for (int z = 0; z < numZ; z++) {
       Chunk &currentChunk = chunks[std::make_pair(x, z)];
@@ -67,11 +183,17 @@ std::map<std::pair<int, int>, Chunk> ChunkGenerator::generateMany(int const &num
       if (z != numZ - 1) {
         currentChunk.neighbourZPlus = &chunks[std::make_pair(x, z + 1)];
       }
-
-      currentChunk.rebuildMesh();
     }
   }
 
+  // meshing only reads the neighbours, each chunk can be meshed on its own
+  forEachRange(chunkSlots.size(), [&chunkSlots, &mesher](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      auto const &[position, chunk] = chunkSlots[i];
+      mesher(position.first, position.second, *chunk);
+    }
+  });
+
   return chunks;
 }
 
@@ -1,13 +1,56 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <map>
+
+#include "Core/Jobs/Scheduler.hpp"
 #include "Game/Chunks/Chunk.hpp"
+#include "Game/Chunks/Generator/TerrainLayers.hpp"
+#include "Game/Chunks/Storage/ChunkStore.hpp"
+#include "Game/Chunks/Storage/MeshCache.hpp"
 
 namespace cbl {
+// terrain of every benchmark, so the microbenchmarks and --benchmark runs measure the same chunks
+constexpr uint32_t BenchmarkSeed = 1337;
+
 struct ChunkGenerator {
 private:
+  using RangeBody = std::function<void(size_t begin, size_t end)>;
+  // runs body over [0, count), split in ranges in any way
+  using ForEachRange = std::function<void(size_t const &count, RangeBody const &body)>;
+  // fills the blocks and position of one chunk
+  using ChunkSource = std::function<Chunk(int const &posX, int const &posZ)>;
+  // fills the mesh of a chunk whose neighbours are all filled
+  using ChunkMesher = std::function<void(int const &posX, int const &posZ, Chunk &chunk)>;
+
+  [[nodiscard]] static Chunk generate(int const &posX, int const &posZ, uint32_t const &seed,
+                                      LayerTile const &layers);
+  [[nodiscard]] static std::map<std::pair<int, int>, Chunk>
+  generateMany(int const &numX, int const &numZ, ChunkSource const &source,
+               ChunkMesher const &mesher, ForEachRange const &forEachRange);
+
 public:
-  [[nodiscard]] static Chunk generate(int const &posX, int const &posZ);
-  [[nodiscard]] static std::map<std::pair<int, int>, Chunk> generateMany(int const &numX,
-                                                                         int const &numZ);
+  // noise of the density field that carves caves and overhangs. Its seed is offset from the world
+  // seed, so that it does not repeat the height noise
+  static constexpr uint32_t DensitySeedOffset = 0x9E3779B9;
+  static constexpr double DensityFrequency = 1.0 / 12.0;
+  static constexpr int DensityOctaves = 2;
+
+  // only computes the layers of its own columns
+  [[nodiscard]] static Chunk generate(int const &posX, int const &posZ, uint32_t const &seed);
+  // with the layer tiles of a cache shared by the chunks generated together
+  [[nodiscard]] static Chunk generate(int const &posX, int const &posZ, LayerTileCache &layers);
+  [[nodiscard]] static std::map<std::pair<int, int>, Chunk>
+  generateMany(int const &numX, int const &numZ, uint32_t const &seed);
+  // generates, then meshes, the chunks in parallel on the scheduler workers
+  [[nodiscard]] static std::map<std::pair<int, int>, Chunk>
+  generateMany(int const &numX, int const &numZ, uint32_t const &seed,
+               jobs::Scheduler &scheduler);
+  // Same as above, but chunks saved in store are loaded instead of generated, and the generated
+  // ones are queued for saving. Meshes found in meshCache are used instead of meshing
+  [[nodiscard]] static std::map<std::pair<int, int>, Chunk>
+  generateMany(int const &numX, int const &numZ, uint32_t const &seed,
+               jobs::Scheduler &scheduler, ChunkStore &store, MeshCache *meshCache = nullptr);
 };
 } // namespace cbl
\ No newline at end of file
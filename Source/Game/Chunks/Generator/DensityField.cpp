@@ -0,0 +1,41 @@
+#include "DensityField.hpp"
+
+#include "Core/Trace/Trace.hpp"
+
+namespace cbl {
+
+DensityField::DensityField(siv::PerlinNoise const &perlin, glm::vec3 const &chunkPosition,
+                           double const &frequency, int const &octaves) {
+  CBL_TRACE_SCOPE("DensityField::DensityField");
+
+  for (unsigned int x = 0; x < mPointsX; x++) {
+    for (unsigned int y = 0; y < mPointsY; y++) {
+      for (unsigned int z = 0; z < mPointsZ; z++) {
+        mSamples[x][y][z] = static_cast<float>(perlin.accumulatedOctaveNoise3D_0_1(
+            (chunkPosition.x + static_cast<double>(x * mLatticeStep)) * frequency,
+            (chunkPosition.y + static_cast<double>(y * mLatticeStep)) * frequency,
+            (chunkPosition.z + static_cast<double>(z * mLatticeStep)) * frequency, octaves));
+      }
+    }
+  }
+}
+
+float DensityField::sample(unsigned int const &x, unsigned int const &y,
+                           unsigned int const &z) const {
+  unsigned int const cellX = x / mLatticeStep;
+  unsigned int const cellY = y / mLatticeStep;
+  unsigned int const cellZ = z / mLatticeStep;
+  float const tx = static_cast<float>(x % mLatticeStep) / mLatticeStep;
+  float const ty = static_cast<float>(y % mLatticeStep) / mLatticeStep;
+  float const tz = static_cast<float>(z % mLatticeStep) / mLatticeStep;
+
+  auto const lerp = [](float const &a, float const &b, float const &t) { return a + (b - a) * t; };
+  auto const lerpZ = [this, &cellZ, &tz, &lerp](unsigned int const &px, unsigned int const &py) {
+    return lerp(mSamples[px][py][cellZ], mSamples[px][py][cellZ + 1], tz);
+  };
+
+  return lerp(lerp(lerpZ(cellX, cellY), lerpZ(cellX, cellY + 1), ty),
+              lerp(lerpZ(cellX + 1, cellY), lerpZ(cellX + 1, cellY + 1), ty), tx);
+}
+
+} // namespace cbl
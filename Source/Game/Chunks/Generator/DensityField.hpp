@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+#include "External/PerlinNoise/PerlinNoise.hpp"
+
+#include "Game/Chunks/Chunk.hpp"
+
+namespace cbl {
+// 3D noise over one chunk, sampled every 4 blocks and trilinearly interpolated in between. Costs
+// one noise sample per 64 blocks instead of one per block
+struct DensityField {
+private:
+  static constexpr unsigned int mLatticeStep = 4;
+
+  // the last lattice points are on the far faces, shared with the next chunks
+  static constexpr unsigned int mPointsX = Chunk::BlocksX / mLatticeStep + 1;
+  static constexpr unsigned int mPointsY = Chunk::BlocksY / mLatticeStep + 1;
+  static constexpr unsigned int mPointsZ = Chunk::BlocksZ / mLatticeStep + 1;
+
+  static_assert(Chunk::BlocksX % mLatticeStep == 0 && Chunk::BlocksY % mLatticeStep == 0 &&
+                    Chunk::BlocksZ % mLatticeStep == 0,
+                "chunks must be made of whole lattice cells");
+
+  std::array<std::array<std::array<float, mPointsZ>, mPointsY>, mPointsX> mSamples{};
+
+public:
+  // noise in [0, 1], at frequency samples per block
+  DensityField(siv::PerlinNoise const &perlin, glm::vec3 const &chunkPosition,
+               double const &frequency, int const &octaves);
+
+  [[nodiscard]] float sample(unsigned int const &x, unsigned int const &y,
+                             unsigned int const &z) const;
+};
+} // namespace cbl
@@ -0,0 +1,163 @@
+#include "TerrainLayers.hpp"
+
+#include <algorithm>
+
+#include "External/PerlinNoise/PerlinNoise.hpp"
+
+#include "Core/Trace/Trace.hpp"
+#include "Math/FloorDivide/FloorDivide.hpp"
+
+namespace cbl {
+
+namespace {
+// every layer has its own noise, derived from the world seed
+constexpr uint32_t TemperatureSeedOffset = 0x85EBCA6B;
+constexpr uint32_t HumiditySeedOffset = 0xC2B2AE35;
+constexpr double ClimateFrequency = 1.0 / 256.0;
+// the climate is sampled every ClimateStep blocks and bilinearly interpolated in between
+constexpr unsigned int ClimateStep = 4;
+
+struct Climate {
+  float temperature;
+  float humidity;
+};
+
+float lerp(float const &a, float const &b, float const &t) { return a + (b - a) * t; }
+
+// 0 at edge0, 1 at edge1, smooth in between. The edges can be in any order
+float smoothStep(float const &edge0, float const &edge1, float const &value) {
+  float const t = std::clamp((value - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+  return t * t * (3.0f - 2.0f * t);
+}
+
+// The height only follows the climate, never the biome, so the terrain stays continuous across
+// biome borders
+TerrainColumn makeColumn(Climate const &climate) {
+  float const hills = smoothStep(0.55f, 0.4f, climate.temperature);
+  float const dryness = smoothStep(0.45f, 0.35f, climate.humidity);
+
+  TerrainColumn column{};
+  if (dryness > 0.5f) {
+    column.biome = Biome::eBarren;
+  } else if (hills > 0.5f) {
+    column.biome = Biome::eHills;
+  } else {
+    column.biome = Biome::ePlains;
+  }
+  column.baseHeight = lerp(6.0f, 8.0f, hills);
+  column.heightVariance = lerp(0.5f, 1.5f, hills) + 0.5f * dryness;
+
+  return column;
+}
+} // namespace
+
+LayerTile::LayerTile(int const &firstChunkX, int const &firstChunkZ, int const &chunkCount,
+                     uint32_t const &seed)
+    : mFirstChunkX{firstChunkX}, mFirstChunkZ{firstChunkZ},
+      mColumnsZ{chunkCount * Chunk::BlocksZ} {
+  CBL_TRACE_SCOPE("LayerTile::LayerTile");
+  static_assert(Chunk::BlocksX % ClimateStep == 0 && Chunk::BlocksZ % ClimateStep == 0,
+                "chunks must be made of whole climate cells");
+  unsigned int const columnsX = chunkCount * Chunk::BlocksX;
+  unsigned int const pointsX = columnsX / ClimateStep + 1;
+  unsigned int const pointsZ = mColumnsZ / ClimateStep + 1;
+
+  siv::PerlinNoise const temperatureNoise{seed + TemperatureSeedOffset};
+  siv::PerlinNoise const humidityNoise{seed + HumiditySeedOffset};
+
+  // the climate points sit on the same grid whatever the size of the tile
+  double const originX = static_cast<double>(firstChunkX) * Chunk::BlocksX;
+  double const originZ = static_cast<double>(firstChunkZ) * Chunk::BlocksZ;
+
+  std::vector<Climate> climate(pointsX * pointsZ);
+  for (unsigned int px = 0; px < pointsX; px++) {
+    for (unsigned int pz = 0; pz < pointsZ; pz++) {
+      double const x = (originX + px * ClimateStep) * ClimateFrequency;
+      double const z = (originZ + pz * ClimateStep) * ClimateFrequency;
+      climate[px * pointsZ + pz] = {
+          static_cast<float>(temperatureNoise.accumulatedOctaveNoise2D_0_1(x, z, 2)),
+          static_cast<float>(humidityNoise.accumulatedOctaveNoise2D_0_1(x, z, 2))};
+    }
+  }
+
+  mColumns.resize(columnsX * mColumnsZ);
+  for (unsigned int x = 0; x < columnsX; x++) {
+    for (unsigned int z = 0; z < mColumnsZ; z++) {
+      unsigned int const px = x / ClimateStep;
+      unsigned int const pz = z / ClimateStep;
+      float const tx = static_cast<float>(x % ClimateStep) / ClimateStep;
+      float const tz = static_cast<float>(z % ClimateStep) / ClimateStep;
+
+      auto const interpolate = [&](float Climate::*field) {
+        auto const at = [&](unsigned int const &i, unsigned int const &j) {
+          return climate[i * pointsZ + j].*field;
+        };
+        return lerp(lerp(at(px, pz), at(px, pz + 1), tz),
+                    lerp(at(px + 1, pz), at(px + 1, pz + 1), tz), tx);
+      };
+
+      mColumns[x * mColumnsZ + z] =
+          makeColumn({interpolate(&Climate::temperature), interpolate(&Climate::humidity)});
+    }
+  }
+}
+
+LayerTile::LayerTile(int const &tileX, int const &tileZ, uint32_t const &seed)
+    : LayerTile{tileX * mTileChunks, tileZ * mTileChunks, mTileChunks, seed} {}
+
+LayerTile LayerTile::forChunk(int const &chunkX, int const &chunkZ, uint32_t const &seed) {
+  return LayerTile{chunkX, chunkZ, 1, seed};
+}
+
+std::pair<int, int> LayerTile::locate(int const &chunkX, int const &chunkZ) {
+  return {floorDivide(chunkX, mTileChunks), floorDivide(chunkZ, mTileChunks)};
+}
+
+TerrainColumn const &LayerTile::getColumn(int const &chunkX, int const &chunkZ,
+                                          unsigned int const &x, unsigned int const &z) const {
+  unsigned int const columnX = (chunkX - mFirstChunkX) * Chunk::BlocksX + x;
+  unsigned int const columnZ = (chunkZ - mFirstChunkZ) * Chunk::BlocksZ + z;
+  return mColumns[columnX * mColumnsZ + columnZ];
+}
+
+LayerTileCache::LayerTileCache(uint32_t const &seed, size_t const &capacity)
+    : mSeed{seed}, mCapacity{std::max(capacity, size_t{1})} {}
+
+std::shared_ptr<LayerTile const> LayerTileCache::get(int const &chunkX, int const &chunkZ) {
+  TilePosition const position = LayerTile::locate(chunkX, chunkZ);
+  std::promise<std::shared_ptr<LayerTile const>> promise{};
+  Tile tile{};
+  bool missed = false;
+
+  {
+    std::lock_guard<std::mutex> lock{mMutex};
+    auto const found = mTiles.find(position);
+
+    if (found != mTiles.end()) {
+      mRecentlyUsed.splice(mRecentlyUsed.begin(), mRecentlyUsed, found->second.second);
+      tile = found->second.first;
+    } else {
+      tile = promise.get_future().share();
+      mRecentlyUsed.push_front(position);
+      mTiles.emplace(position, std::make_pair(tile, mRecentlyUsed.begin()));
+      missed = true;
+
+      // jobs still computing or reading an evicted tile keep their own reference to it
+      if (mTiles.size() > mCapacity) {
+        mTiles.erase(mRecentlyUsed.back());
+        mRecentlyUsed.pop_back();
+      }
+    }
+  }
+
+  // computed outside the lock, jobs that need another tile do not wait for this one
+  if (missed) {
+    promise.set_value(std::make_shared<LayerTile const>(position.first, position.second, mSeed));
+  }
+
+  return tile.get();
+}
+
+uint32_t LayerTileCache::getSeed() const { return mSeed; }
+
+} // namespace cbl
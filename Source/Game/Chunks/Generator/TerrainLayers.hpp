@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Game/Chunks/Chunk.hpp"
+
+namespace cbl {
+enum class Biome : uint8_t { ePlains, eHills, eBarren };
+
+// what the low frequency layers decided for one column of blocks
+struct TerrainColumn {
+  Biome biome;
+  float baseHeight;     // in blocks
+  float heightVariance; // scales the detail noise of the chunk around baseHeight
+};
+
+// Low frequency layers of the terrain over a square of chunks: the climate, the biome map it gives,
+// and the shape of the terrain height. They barely change from one chunk to the next, so chunks
+// generated together share a tile of 4 x 4 chunks. A chunk generated alone only gets its own
+// columns, which hold the same values as in the tile
+struct LayerTile {
+private:
+  static constexpr int mTileChunks = 4;
+
+  int mFirstChunkX;
+  int mFirstChunkZ;
+  unsigned int mColumnsZ;
+  std::vector<TerrainColumn> mColumns{}; // x major
+
+  LayerTile(int const &firstChunkX, int const &firstChunkZ, int const &chunkCount,
+            uint32_t const &seed);
+
+public:
+  LayerTile(int const &tileX, int const &tileZ, uint32_t const &seed);
+  [[nodiscard]] static LayerTile forChunk(int const &chunkX, int const &chunkZ,
+                                          uint32_t const &seed);
+
+  // tile holding the chunk
+  [[nodiscard]] static std::pair<int, int> locate(int const &chunkX, int const &chunkZ);
+
+  // x and z are block coordinates inside the chunk, which must be in this tile
+  [[nodiscard]] TerrainColumn const &getColumn(int const &chunkX, int const &chunkZ,
+                                               unsigned int const &x,
+                                               unsigned int const &z) const;
+};
+
+// Keeps the most recently used layer tiles of one seed, so the chunk jobs of a tile share them
+// instead of computing them again. Safe from any thread, a tile asked for by several jobs at once
+// is only computed by the first one
+struct LayerTileCache {
+private:
+  using TilePosition = std::pair<int, int>;
+  using Tile = std::shared_future<std::shared_ptr<LayerTile const>>;
+
+  uint32_t mSeed;
+  size_t mCapacity;
+
+  std::mutex mMutex{};
+  std::list<TilePosition> mRecentlyUsed{}; // most recent first
+  std::map<TilePosition, std::pair<Tile, std::list<TilePosition>::iterator>> mTiles{};
+
+public:
+  static constexpr size_t DefaultCapacity = 64;
+
+  LayerTileCache() = delete;
+  LayerTileCache(LayerTileCache const &) = delete;
+  explicit LayerTileCache(uint32_t const &seed, size_t const &capacity = DefaultCapacity);
+
+  void operator=(LayerTileCache const &) = delete;
+
+  // tile holding the chunk
+  [[nodiscard]] std::shared_ptr<LayerTile const> get(int const &chunkX, int const &chunkZ);
+  [[nodiscard]] uint32_t getSeed() const;
+};
+} // namespace cbl
@@ -0,0 +1,160 @@
+#include "ChunkStore.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <tuple>
+
+#include "Core/Trace/Trace.hpp"
+#include "Game/Chunks/Storage/RegionFile.hpp"
+
+namespace cbl {
+
+ChunkStore::ChunkStore(std::filesystem::path directory) : mDirectory{std::move(directory)} {
+  std::filesystem::create_directories(mDirectory);
+  mWriter = std::thread{&ChunkStore::writerLoop, this};
+}
+
+ChunkStore::~ChunkStore() {
+  {
+    std::lock_guard<std::mutex> lock{mQueueMutex};
+    mStopping = true;
+  }
+  mQueueChanged.notify_all();
+
+  // the writer only exits once the queue is empty
+  mWriter.join();
+}
+
+std::optional<uint32_t> ChunkStore::loadSeed() const {
+  std::ifstream file{mDirectory / mSeedFileName};
+  uint32_t seed = 0;
+  if (!(file >> seed)) {
+    return std::nullopt;
+  }
+
+  return seed;
+}
+
+void ChunkStore::saveSeed(uint32_t const &seed) const {
+  std::filesystem::path const path = mDirectory / mSeedFileName;
+  std::ofstream file{path, std::ios::trunc};
+  file << seed << '\n';
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path.string());
+  }
+}
+
+std::shared_ptr<MappedFile const> ChunkStore::getMapping(int const &regionX,
+                                                         int const &regionZ) {
+  std::lock_guard<std::mutex> lock{mMappingsMutex};
+  auto const [mapping, inserted] = mMappings.try_emplace(std::make_pair(regionX, regionZ));
+
+  if (inserted) {
+    std::filesystem::path const path = RegionFile::getPath(mDirectory, regionX, regionZ);
+    if (std::filesystem::exists(path)) {
+      mapping->second = std::make_shared<MappedFile const>(path);
+    }
+  }
+
+  return mapping->second;
+}
+
+bool ChunkStore::load(int const &chunkX, int const &chunkZ, Chunk &chunk) {
+  CBL_TRACE_SCOPE("ChunkStore::load");
+  RegionFile::Location const location = RegionFile::locate(chunkX, chunkZ);
+
+  try {
+    std::shared_lock<std::shared_mutex> lock{mFilesMutex};
+    std::shared_ptr<MappedFile const> const file = getMapping(location.regionX, location.regionZ);
+
+    if (file == nullptr || !RegionFile::read(*file, location.slot, chunk)) {
+      return false;
+    }
+  } catch (std::exception const &exception) {
+    // a broken chunk is generated again, and replaces the broken data once saved
+    std::cerr << "Failed to load chunk " << chunkX << ", " << chunkZ << " : " << exception.what()
+              << '\n';
+    return false;
+  }
+
+  chunk.position = glm::vec3{chunkX * static_cast<int>(Chunk::BlocksX), 0.0f,
+                             chunkZ * static_cast<int>(Chunk::BlocksZ)};
+  return true;
+}
+
+void ChunkStore::save(int const &chunkX, int const &chunkZ, Chunk const &chunk) {
+  CBL_TRACE_SCOPE("ChunkStore::save");
+  RegionFile::Location const location = RegionFile::locate(chunkX, chunkZ);
+  std::vector<uint8_t> data = RegionFile::encode(chunk);
+
+  {
+    std::lock_guard<std::mutex> lock{mQueueMutex};
+    mQueue.push_back({location.regionX, location.regionZ, location.slot, std::move(data)});
+  }
+  mQueueChanged.notify_all();
+}
+
+void ChunkStore::writerLoop() {
+  CBL_TRACE_THREAD_NAME("Chunk writer");
+  std::vector<PendingChunk> chunks{};
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{mQueueMutex};
+      mQueueChanged.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+      if (mQueue.empty()) {
+        return;
+      }
+
+      // everything queued so far is written in one pass, opening each region file once
+      chunks.swap(mQueue);
+    }
+
+    try {
+      writeChunks(chunks);
+    } catch (std::exception const &exception) {
+      // the chunks are generated again on the next launch
+      std::cerr << "Failed to save chunks : " << exception.what() << '\n';
+    }
+    chunks.clear();
+  }
+}
+
+void ChunkStore::writeChunks(std::vector<PendingChunk> &chunks) {
+  CBL_TRACE_SCOPE("ChunkStore::writeChunks");
+  std::stable_sort(chunks.begin(), chunks.end(),
+                   [](PendingChunk const &left, PendingChunk const &right) {
+                     return std::tie(left.regionX, left.regionZ) <
+                            std::tie(right.regionX, right.regionZ);
+                   });
+
+  std::unique_lock<std::shared_mutex> lock{mFilesMutex};
+
+  for (auto regionBegin = chunks.begin(); regionBegin != chunks.end();) {
+    auto const regionEnd =
+        std::find_if(regionBegin, chunks.end(), [&regionBegin](PendingChunk const &chunk) {
+          return chunk.regionX != regionBegin->regionX || chunk.regionZ != regionBegin->regionZ;
+        });
+
+    // a chunk saved twice keeps its newest data, the later slot entry wins
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> regionChunks{};
+    for (auto chunk = regionBegin; chunk != regionEnd; chunk++) {
+      regionChunks.emplace_back(chunk->slot, std::move(chunk->data));
+    }
+
+    // nothing reads the region while the lock is held, its mapping is made again on the next load
+    {
+      std::lock_guard<std::mutex> mappingsLock{mMappingsMutex};
+      mMappings.erase(std::make_pair(regionBegin->regionX, regionBegin->regionZ));
+    }
+
+    RegionFile::write(RegionFile::getPath(mDirectory, regionBegin->regionX, regionBegin->regionZ),
+                      regionChunks);
+    regionBegin = regionEnd;
+  }
+}
+
+} // namespace cbl
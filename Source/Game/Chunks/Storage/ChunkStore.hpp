@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Core/IO/MappedFile.hpp"
+#include "Game/Chunks/Chunk.hpp"
+
+namespace cbl {
+// A saved world: the seed it was generated with, and its chunks in region files. Chunks are read
+// through memory mapped region files, and compressed chunks are written by a background thread so
+// saving never waits on the disk. Loading and saving are safe from any thread
+struct ChunkStore {
+private:
+  struct PendingChunk {
+    int regionX;
+    int regionZ;
+    size_t slot;
+    std::vector<uint8_t> data;
+  };
+
+  static constexpr char const *mSeedFileName = "seed.txt";
+
+  std::filesystem::path mDirectory;
+
+  // loads share it, the writer takes it alone while it changes a region file
+  std::shared_mutex mFilesMutex{};
+  std::mutex mMappingsMutex{};
+  // null for the regions without a file yet
+  std::map<std::pair<int, int>, std::shared_ptr<MappedFile const>> mMappings{};
+
+  std::mutex mQueueMutex{};
+  std::condition_variable mQueueChanged{};
+  std::vector<PendingChunk> mQueue{};
+  bool mStopping = false;
+  std::thread mWriter{};
+
+  void writerLoop();
+  void writeChunks(std::vector<PendingChunk> &chunks);
+  [[nodiscard]] std::shared_ptr<MappedFile const> getMapping(int const &regionX,
+                                                             int const &regionZ);
+
+public:
+  ChunkStore() = delete;
+  ChunkStore(ChunkStore const &) = delete;
+  // creates the directory when it does not exist
+  explicit ChunkStore(std::filesystem::path directory);
+  // writes every queued chunk before returning
+  ~ChunkStore();
+
+  void operator=(ChunkStore const &) = delete;
+
+  [[nodiscard]] std::optional<uint32_t> loadSeed() const;
+  void saveSeed(uint32_t const &seed) const;
+
+  // Fills the blocks and position of chunk. False when it was never saved or cannot be read, it
+  // then has to be generated again
+  [[nodiscard]] bool load(int const &chunkX, int const &chunkZ, Chunk &chunk);
+  // compresses the blocks on the calling thread, the writer thread puts them on disk later
+  void save(int const &chunkX, int const &chunkZ, Chunk const &chunk);
+};
+} // namespace cbl
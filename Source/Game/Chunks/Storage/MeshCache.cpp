@@ -0,0 +1,225 @@
+#include "MeshCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "Core/Trace/Trace.hpp"
+
+namespace cbl {
+
+namespace {
+// 64 bit FNV-1a
+constexpr uint64_t HashOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t HashPrime = 1099511628211ull;
+
+void hashBytes(uint64_t &hash, void const *data, size_t const &size) {
+  auto const *bytes = static_cast<uint8_t const *>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * HashPrime;
+  }
+}
+
+// meshing only checks whether the neighbour blocks touching the chunk are air
+template <typename IsAir>
+void hashBorder(uint64_t &hash, Chunk const *neighbour, unsigned int const &width,
+                IsAir const &isAir) {
+  uint8_t const present = neighbour != nullptr;
+  hashBytes(hash, &present, sizeof(present));
+
+  if (neighbour == nullptr) {
+    return;
+  }
+
+  for (unsigned int i = 0; i < width; i++) {
+    for (unsigned int y = 0; y < Chunk::BlocksY; y++) {
+      uint8_t const air = isAir(*neighbour, i, y);
+      hashBytes(hash, &air, sizeof(air));
+    }
+  }
+}
+
+size_t getEntrySize(uint32_t const &indexCount, uint32_t const &vertexCount) {
+  return indexCount * sizeof(uint32_t) + vertexCount * sizeof(gfx::Vertex);
+}
+} // namespace
+
+MeshCache::MeshCache(std::filesystem::path path) : mPath{std::move(path)} {
+  CBL_TRACE_SCOPE("MeshCache::MeshCache");
+  mapFile();
+}
+
+MeshCache::~MeshCache() {
+  try {
+    save();
+  } catch (std::exception const &exception) {
+    // losing the cache only costs the next startup some meshing
+    std::cerr << "Failed to save the mesh cache : " << exception.what() << '\n';
+  }
+}
+
+void MeshCache::mapFile() {
+  mFile = MappedFile{};
+  mEntries.clear();
+
+  try {
+    if (std::filesystem::exists(mPath)) {
+      mFile = MappedFile{mPath};
+    }
+  } catch (std::exception const &) {
+    return;
+  }
+
+  auto const *bytes = static_cast<uint8_t const *>(mFile.data());
+  FileHeader header{};
+  if (mFile.size() < sizeof(header)) {
+    return;
+  }
+
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::memcmp(header.magic, mMagic, sizeof(mMagic)) != 0 || header.version != mVersion) {
+    // written by another engine version, start from an empty cache
+    return;
+  }
+
+  // only the entry headers are touched here, the mesh data is paged in when found
+  size_t offset = sizeof(header);
+  for (uint32_t i = 0; i < header.entryCount; i++) {
+    EntryHeader entry{};
+    if (mFile.size() - offset < sizeof(entry)) {
+      mEntries.clear();
+      return;
+    }
+
+    std::memcpy(&entry, bytes + offset, sizeof(entry));
+    size_t const entrySize = sizeof(entry) + getEntrySize(entry.indexCount, entry.vertexCount);
+    if (mFile.size() - offset < entrySize) {
+      mEntries.clear();
+      return;
+    }
+
+    mEntries[std::make_pair(entry.chunkX, entry.chunkZ)] = offset;
+    offset += entrySize;
+  }
+}
+
+uint64_t MeshCache::hash(Chunk const &chunk) {
+  uint64_t hash = HashOffsetBasis;
+
+  // one byte per block, the types all fit in it
+  for (auto const &plane : chunk.blocks) {
+    for (auto const &row : plane) {
+      for (Block::Type const &block : row) {
+        hash = (hash ^ static_cast<uint8_t>(block)) * HashPrime;
+      }
+    }
+  }
+
+  hashBorder(hash, chunk.neighbourXMinus, Chunk::BlocksZ,
+             [](Chunk const &neighbour, unsigned int const &z, unsigned int const &y) {
+               return neighbour.blocks[Chunk::BlocksX - 1][y][z] == Block::Type::eAir;
+             });
+  hashBorder(hash, chunk.neighbourXPlus, Chunk::BlocksZ,
+             [](Chunk const &neighbour, unsigned int const &z, unsigned int const &y) {
+               return neighbour.blocks[0][y][z] == Block::Type::eAir;
+             });
+  hashBorder(hash, chunk.neighbourZMinus, Chunk::BlocksX,
+             [](Chunk const &neighbour, unsigned int const &x, unsigned int const &y) {
+               return neighbour.blocks[x][y][Chunk::BlocksZ - 1] == Block::Type::eAir;
+             });
+  hashBorder(hash, chunk.neighbourZPlus, Chunk::BlocksX,
+             [](Chunk const &neighbour, unsigned int const &x, unsigned int const &y) {
+               return neighbour.blocks[x][y][0] == Block::Type::eAir;
+             });
+
+  return hash;
+}
+
+bool MeshCache::find(int const &chunkX, int const &chunkZ, uint64_t const &hash,
+                     ChunkMesh &mesh) const {
+  auto const entry = mEntries.find(std::make_pair(chunkX, chunkZ));
+  if (entry == mEntries.end()) {
+    return false;
+  }
+
+  auto const *bytes = static_cast<uint8_t const *>(mFile.data()) + entry->second;
+  EntryHeader header{};
+  std::memcpy(&header, bytes, sizeof(header));
+  if (header.hash != hash) {
+    return false;
+  }
+
+  bytes += sizeof(header);
+  mesh.indices.resize(header.indexCount);
+  std::memcpy(mesh.indices.data(), bytes, header.indexCount * sizeof(uint32_t));
+
+  bytes += header.indexCount * sizeof(uint32_t);
+  mesh.vertices.resize(header.vertexCount);
+  std::memcpy(mesh.vertices.data(), bytes, header.vertexCount * sizeof(gfx::Vertex));
+
+  return true;
+}
+
+void MeshCache::store(int const &chunkX, int const &chunkZ, uint64_t const &hash,
+                      ChunkMesh const &mesh) {
+  std::lock_guard<std::mutex> lock{mNewEntriesMutex};
+  mNewEntries[std::make_pair(chunkX, chunkZ)] = Entry{hash, mesh.indices, mesh.vertices};
+}
+
+void MeshCache::save() {
+  std::lock_guard<std::mutex> lock{mNewEntriesMutex};
+  if (mNewEntries.empty()) {
+    return;
+  }
+
+  // the meshes that were not replaced are copied as they are
+  std::map<std::pair<int, int>, size_t> keptEntries{mEntries};
+  for (auto const &[position, entry] : mNewEntries) {
+    keptEntries.erase(position);
+  }
+
+  std::filesystem::path const temporaryPath = mPath.string() + ".tmp";
+  {
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+
+    FileHeader header{};
+    std::memcpy(header.magic, mMagic, sizeof(mMagic));
+    header.version = mVersion;
+    header.entryCount = static_cast<uint32_t>(keptEntries.size() + mNewEntries.size());
+    file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+    auto const *bytes = static_cast<char const *>(mFile.data());
+    for (auto const &[position, offset] : keptEntries) {
+      EntryHeader entry{};
+      std::memcpy(&entry, bytes + offset, sizeof(entry));
+      file.write(bytes + offset, static_cast<std::streamsize>(
+                                     sizeof(entry) +
+                                     getEntrySize(entry.indexCount, entry.vertexCount)));
+    }
+
+    for (auto const &[position, newEntry] : mNewEntries) {
+      EntryHeader entry{position.first, position.second, newEntry.hash,
+                        static_cast<uint32_t>(newEntry.indices.size()),
+                        static_cast<uint32_t>(newEntry.vertices.size())};
+      file.write(reinterpret_cast<char const *>(&entry), sizeof(entry));
+      file.write(reinterpret_cast<char const *>(newEntry.indices.data()),
+                 static_cast<std::streamsize>(newEntry.indices.size() * sizeof(uint32_t)));
+      file.write(reinterpret_cast<char const *>(newEntry.vertices.data()),
+                 static_cast<std::streamsize>(newEntry.vertices.size() * sizeof(gfx::Vertex)));
+    }
+
+    if (!file) {
+      throw std::runtime_error("Failed to write " + temporaryPath.string());
+    }
+  }
+
+  // a mapped file cannot be replaced on every platform
+  mFile = MappedFile{};
+  std::filesystem::rename(temporaryPath, mPath);
+
+  mNewEntries.clear();
+  mapFile();
+}
+
+} // namespace cbl
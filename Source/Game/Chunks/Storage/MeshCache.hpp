@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Core/IO/MappedFile.hpp"
+#include "Game/Chunks/Chunk.hpp"
+
+namespace cbl {
+// Finished chunk meshes, in the vertex layout they are uploaded with, saved from one run to the
+// next. Each chunk position keeps one mesh, tagged with the hash of what it was built from. A chunk
+// or neighbour that changed since gives another hash, and its mesh is built again. The file is
+// read through a memory mapping, and rewritten when saved
+struct MeshCache {
+private:
+  struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+  };
+
+  // followed by the indices, then the vertices
+  struct EntryHeader {
+    int32_t chunkX;
+    int32_t chunkZ;
+    uint64_t hash;
+    uint32_t indexCount;
+    uint32_t vertexCount;
+  };
+
+  struct Entry {
+    uint64_t hash;
+    std::vector<uint32_t> indices;
+    std::vector<gfx::Vertex> vertices;
+  };
+
+  static constexpr char mMagic[4] = {'C', 'B', 'L', 'M'};
+  // bump whenever the mesher output changes, the cached meshes are then all built again
+  static constexpr uint32_t mVersion = 1;
+
+  std::filesystem::path mPath;
+  MappedFile mFile{};
+  // offset of every entry in mFile
+  std::map<std::pair<int, int>, size_t> mEntries{};
+
+  std::mutex mNewEntriesMutex{};
+  std::map<std::pair<int, int>, Entry> mNewEntries{};
+
+  void mapFile();
+
+public:
+  static constexpr char const *FileName = "meshes.bin";
+
+  MeshCache() = delete;
+  MeshCache(MeshCache const &) = delete;
+  // an unreadable or outdated file is ignored, as if it was empty
+  explicit MeshCache(std::filesystem::path path);
+  ~MeshCache();
+
+  void operator=(MeshCache const &) = delete;
+
+  // of the blocks the mesh of chunk is built from, including the borders of its neighbours
+  [[nodiscard]] static uint64_t hash(Chunk const &chunk);
+
+  // False when the cached mesh was built from other blocks, or there is none. Safe from any thread
+  [[nodiscard]] bool find(int const &chunkX, int const &chunkZ, uint64_t const &hash,
+                          ChunkMesh &mesh) const;
+  // kept in memory until saved. Safe from any thread
+  void store(int const &chunkX, int const &chunkZ, uint64_t const &hash, ChunkMesh const &mesh);
+
+  // Writes to a temporary file first, an interrupted save never leaves a corrupt cache behind.
+  // Nothing else may use the cache meanwhile
+  void save();
+};
+} // namespace cbl
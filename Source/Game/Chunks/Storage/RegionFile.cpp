@@ -0,0 +1,209 @@
+#include "RegionFile.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "Math/FloorDivide/FloorDivide.hpp"
+
+namespace cbl {
+
+namespace {
+// eDirt is the last block type
+constexpr uint8_t BlockTypeCount = static_cast<uint8_t>(Block::Type::eDirt) + 1;
+constexpr size_t BlocksPerChunk = Chunk::BlocksX * Chunk::BlocksY * Chunk::BlocksZ;
+constexpr size_t RunBytes = 3; // 16 bit length, then the palette index
+static_assert(BlocksPerChunk <= std::numeric_limits<uint16_t>::max(),
+              "a run covering the whole chunk must fit its length");
+
+template <typename Visitor> void forEachBlockByColumn(Visitor const &visitor) {
+  for (unsigned int x = 0; x < Chunk::BlocksX; x++) {
+    for (unsigned int z = 0; z < Chunk::BlocksZ; z++) {
+      for (unsigned int y = 0; y < Chunk::BlocksY; y++) {
+        visitor(x, y, z);
+      }
+    }
+  }
+}
+} // namespace
+
+RegionFile::Header RegionFile::makeHeader() {
+  Header header{};
+  std::memcpy(header.magic, mMagic, sizeof(mMagic));
+  header.version = mVersion;
+  return header;
+}
+
+bool RegionFile::isValid(Header const &header) {
+  return std::memcmp(header.magic, mMagic, sizeof(mMagic)) == 0 && header.version == mVersion;
+}
+
+RegionFile::Location RegionFile::locate(int const &chunkX, int const &chunkZ) {
+  int const regionX = floorDivide(chunkX, mRegionSize);
+  int const regionZ = floorDivide(chunkZ, mRegionSize);
+  size_t const localX = static_cast<size_t>(chunkX - regionX * mRegionSize);
+  size_t const localZ = static_cast<size_t>(chunkZ - regionZ * mRegionSize);
+
+  return {regionX, regionZ, localX * mRegionSize + localZ};
+}
+
+std::filesystem::path RegionFile::getPath(std::filesystem::path const &directory,
+                                          int const &regionX, int const &regionZ) {
+  return directory / ("r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".cbr");
+}
+
+std::vector<uint8_t> RegionFile::encode(Chunk const &chunk) {
+  std::array<int, BlockTypeCount> paletteIndices{};
+  paletteIndices.fill(-1);
+  std::vector<uint8_t> palette{};
+
+  forEachBlockByColumn([&](unsigned int x, unsigned int y, unsigned int z) {
+    auto const type = static_cast<uint8_t>(chunk.blocks[x][y][z]);
+    if (paletteIndices[type] < 0) {
+      paletteIndices[type] = static_cast<int>(palette.size());
+      palette.push_back(type);
+    }
+  });
+
+  std::vector<uint8_t> data{};
+  data.push_back(static_cast<uint8_t>(palette.size()));
+  data.insert(data.end(), palette.begin(), palette.end());
+
+  uint16_t runLength = 0;
+  uint8_t runIndex = 0;
+  auto const endRun = [&data, &runLength, &runIndex]() {
+    data.push_back(static_cast<uint8_t>(runLength & 0xFF));
+    data.push_back(static_cast<uint8_t>(runLength >> 8));
+    data.push_back(runIndex);
+  };
+
+  forEachBlockByColumn([&](unsigned int x, unsigned int y, unsigned int z) {
+    auto const index =
+        static_cast<uint8_t>(paletteIndices[static_cast<uint8_t>(chunk.blocks[x][y][z])]);
+
+    if (runLength > 0 && index != runIndex) {
+      endRun();
+      runLength = 0;
+    }
+
+    runIndex = index;
+    runLength++;
+  });
+  endRun();
+
+  return data;
+}
+
+void RegionFile::decode(uint8_t const *data, size_t const &size, Chunk &chunk) {
+  if (size < 1 || size < 1 + static_cast<size_t>(data[0])) {
+    throw std::runtime_error("Chunk data is too short for its palette");
+  }
+
+  size_t const paletteSize = data[0];
+  uint8_t const *palette = data + 1;
+  for (size_t i = 0; i < paletteSize; i++) {
+    if (palette[i] >= BlockTypeCount) {
+      throw std::runtime_error("Chunk data has an unknown block type");
+    }
+  }
+
+  // expands the runs in the same order encode walked the blocks
+  uint8_t const *run = palette + paletteSize;
+  uint8_t const *const end = data + size;
+  size_t remaining = 0;
+  Block::Type type{};
+
+  forEachBlockByColumn([&](unsigned int x, unsigned int y, unsigned int z) {
+    if (remaining == 0) {
+      if (end - run < static_cast<ptrdiff_t>(RunBytes)) {
+        throw std::runtime_error("Chunk data ends before its last block");
+      }
+
+      remaining = static_cast<size_t>(run[0]) | static_cast<size_t>(run[1]) << 8;
+      if (remaining == 0 || run[2] >= paletteSize) {
+        throw std::runtime_error("Chunk data has an invalid run");
+      }
+
+      type = static_cast<Block::Type>(palette[run[2]]);
+      run += RunBytes;
+    }
+
+    chunk.blocks[x][y][z] = type;
+    remaining--;
+  });
+
+  if (remaining != 0 || run != end) {
+    throw std::runtime_error("Chunk data holds more than " + std::to_string(BlocksPerChunk) +
+                             " blocks");
+  }
+}
+
+bool RegionFile::read(MappedFile const &file, size_t const &slot, Chunk &chunk) {
+  Header header{};
+  if (file.size() < sizeof(header)) {
+    throw std::runtime_error("Region file is smaller than its header");
+  }
+
+  auto const *bytes = static_cast<uint8_t const *>(file.data());
+  std::memcpy(&header, bytes, sizeof(header));
+  if (!isValid(header)) {
+    throw std::runtime_error("Region file has an unknown format");
+  }
+
+  Slot const &chunkSlot = header.slots[slot];
+  if (chunkSlot.size == 0) {
+    return false;
+  }
+
+  if (static_cast<size_t>(chunkSlot.offset) + chunkSlot.size > file.size()) {
+    throw std::runtime_error("Region file is missing chunk data");
+  }
+
+  // only the pages holding this chunk are loaded
+  decode(bytes + chunkSlot.offset, chunkSlot.size, chunk);
+  return true;
+}
+
+void RegionFile::write(std::filesystem::path const &path,
+                       std::vector<std::pair<size_t, std::vector<uint8_t>>> const &chunks) {
+  Header header = makeHeader();
+
+  if (!std::filesystem::exists(path)) {
+    std::ofstream newFile{path, std::ios::binary};
+    newFile.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    if (!newFile) {
+      throw std::runtime_error("Failed to create " + path.string());
+    }
+  }
+
+  std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+  file.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!file || !isValid(header)) {
+    throw std::runtime_error(path.string() + " is not a region file");
+  }
+
+  file.seekp(0, std::ios::end);
+  for (auto const &[slot, data] : chunks) {
+    auto const offset = static_cast<uint64_t>(file.tellp());
+    if (offset + data.size() > std::numeric_limits<uint32_t>::max()) {
+      throw std::runtime_error(path.string() + " is full");
+    }
+
+    file.write(reinterpret_cast<char const *>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    header.slots[slot] = {static_cast<uint32_t>(offset), static_cast<uint32_t>(data.size())};
+  }
+
+  // the header goes last, an interrupted write leaves the previous chunks in use
+  file.seekp(0);
+  file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path.string());
+  }
+}
+
+} // namespace cbl
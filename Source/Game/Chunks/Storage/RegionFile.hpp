@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include "Core/IO/MappedFile.hpp"
+#include "Game/Chunks/Chunk.hpp"
+
+namespace cbl {
+// Stores 16 x 16 chunks in one file. The header indexes every chunk by offset and size, so any
+// chunk can be read without touching the others. Chunks are only ever appended, a saved chunk
+// leaves its previous bytes unused in the file
+struct RegionFile {
+private:
+  static constexpr int mRegionSize = 16;
+  static constexpr size_t mSlotCount = mRegionSize * mRegionSize;
+  static constexpr char mMagic[4] = {'C', 'B', 'L', 'R'};
+  static constexpr uint32_t mVersion = 1;
+
+  struct Slot {
+    uint32_t offset;
+    uint32_t size; // 0 when the chunk was never saved
+  };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    Slot slots[mSlotCount];
+  };
+
+  [[nodiscard]] static Header makeHeader();
+  [[nodiscard]] static bool isValid(Header const &header);
+
+public:
+  // region of a chunk, and the index of its slot in that region
+  struct Location {
+    int regionX;
+    int regionZ;
+    size_t slot;
+  };
+
+  [[nodiscard]] static Location locate(int const &chunkX, int const &chunkZ);
+  [[nodiscard]] static std::filesystem::path
+  getPath(std::filesystem::path const &directory, int const &regionX, int const &regionZ);
+
+  // Palette of the block types in the chunk, followed by runs of palette indices. Blocks are
+  // walked column by column, bottom to top, so terrain layers turn into a few runs per column
+  [[nodiscard]] static std::vector<uint8_t> encode(Chunk const &chunk);
+  // only fills the blocks, throws std::runtime_error when the data is not a valid chunk
+  static void decode(uint8_t const *data, size_t const &size, Chunk &chunk);
+
+  // false when the slot is empty, throws std::runtime_error when the file is not a valid region
+  [[nodiscard]] static bool read(MappedFile const &file, size_t const &slot, Chunk &chunk);
+  // appends every encoded chunk, then points their slots at them. Creates the file if needed
+  static void write(std::filesystem::path const &path,
+                    std::vector<std::pair<size_t, std::vector<uint8_t>>> const &chunks);
+};
+} // namespace cbl
@@ -2,21 +2,75 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define SDL_MAIN_HANDLED
 
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Core/Time/StartupTimer.hpp"
 #include "Graphics/Engine/Engine.hpp"
 
 #include "Game/Chunks/Generator/ChunkGenerator.hpp"
 
 void setupScene(cbl::gfx::Engine &rendererEngine, cbl::World &scene) {}
 
-int main() {
-  cbl::gfx::Engine renderEngine{};
+int main(int argc, char *argv[]) {
+  cbl::gfx::EngineConfig const config = cbl::gfx::EngineConfig::fromArguments(argc, argv);
+
+  // declared before the scheduler, so they outlive its workers if the engine fails to start
+  std::optional<cbl::ChunkStore> store{};
+  std::optional<cbl::MeshCache> meshCache{};
+  std::map<std::pair<int, int>, cbl::Chunk> chunks{};
+  cbl::jobs::Counter generation{};
+
+  // benchmarks always run over the same terrain, saved worlds keep the seed they started with
+  uint32_t seed = cbl::BenchmarkSeed;
+  if (config.benchmarkFrames == 0) {
+    if (!config.worldDirectory.empty()) {
+      store.emplace(config.worldDirectory);
+      if (config.meshCache) {
+        meshCache.emplace(std::filesystem::path{config.worldDirectory} / cbl::MeshCache::FileName);
+      }
+    }
+
+    std::optional<uint32_t> const savedSeed = store ? store->loadSeed() : std::nullopt;
+    seed = savedSeed.value_or(static_cast<uint32_t>(std::time(nullptr)));
+    if (store && !savedSeed) {
+      store->saveSeed(seed);
+    }
+  }
+
+  cbl::jobs::Scheduler jobs{};
+
+  // the terrain is loaded or generated on the workers while this thread brings up the window and
+  // the GPU
+  jobs.schedule(
+      [&chunks, &seed, &jobs, &store, &meshCache]() {
+        cbl::StartupTimer::Phase phase{"World generation"};
+        chunks = store ? cbl::ChunkGenerator::generateMany(5, 5, seed, jobs, *store,
+                                                           meshCache ? &*meshCache : nullptr)
+                       : cbl::ChunkGenerator::generateMany(5, 5, seed, jobs);
+      },
+      &generation);
+
+  auto const engineStart = cbl::StartupTimer::now();
+  cbl::gfx::Engine renderEngine{jobs, config};
+  cbl::StartupTimer::record("Engine initialization", engineStart);
 
-  auto chunks = cbl::ChunkGenerator::generateMany(5, 5);
+  jobs.wait(generation);
 
   cbl::World world;
-  for (auto const &chunk : chunks) {
-    world.meshes.push_back(chunk.second.mesh);
+  for (auto const &[chunkPosition, chunk] : chunks) {
+    cbl::gfx::Mesh mesh{chunk.mesh.indices, chunk.mesh.vertices};
+    mesh.position = glm::translate(glm::mat4{1.0f}, chunk.position);
+    world.meshes.push_back(mesh);
   }
+  world.chunkStats.chunkCount = chunks.size();
+  world.chunkStats.blockStorageBytes = chunks.size() * sizeof(cbl::Chunk::blocks);
 
   renderEngine.loadWorld(world);
 
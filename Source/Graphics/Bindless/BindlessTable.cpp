@@ -0,0 +1,232 @@
+#include "BindlessTable.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#include "Graphics/Utils/VulkanHelpers.hpp"
+
+namespace cbl::gfx {
+
+BindlessTable::BindlessTable(GPU const &gpu, mem::MemoryManager &memoryManager)
+    : mGPU{gpu}, mMemoryManager{memoryManager} {
+  textureCapacity = std::min(MaxTextures, getDeviceTextureLimit());
+  mTextures.resize(textureCapacity, nullptr);
+
+  std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+  bindings[TextureBinding].binding = TextureBinding;
+  bindings[TextureBinding].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  bindings[TextureBinding].descriptorCount = textureCapacity;
+  bindings[TextureBinding].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+  bindings[MaterialBinding].binding = MaterialBinding;
+  bindings[MaterialBinding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  bindings[MaterialBinding].descriptorCount = 1;
+  bindings[MaterialBinding].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+  // the material buffer is written once, only the textures change after the set is bound
+  std::array<VkDescriptorBindingFlags, 2> bindingFlags{};
+  bindingFlags[TextureBinding] =
+      VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+  VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{};
+  bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+  bindingFlagsCreateInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+  bindingFlagsCreateInfo.pBindingFlags = bindingFlags.data();
+
+  VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+  descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+  descriptorSetLayoutCreateInfo.pBindings = bindings.data();
+  if (mGPU.supportsDescriptorIndexing) {
+    descriptorSetLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+    descriptorSetLayoutCreateInfo.flags =
+        VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+  }
+
+  validateVkResult(vkCreateDescriptorSetLayout(mGPU.device, &descriptorSetLayoutCreateInfo, nullptr,
+                                               &descriptorSetLayout));
+
+  std::array<VkDescriptorPoolSize, 2> poolSizes{
+      VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textureCapacity},
+      VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}};
+
+  VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+  descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+  descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
+  descriptorPoolCreateInfo.maxSets = 1;
+  if (mGPU.supportsDescriptorIndexing) {
+    descriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+  }
+  validateVkResult(
+      vkCreateDescriptorPool(mGPU.device, &descriptorPoolCreateInfo, nullptr, &descriptorPool));
+
+  VkDescriptorSetAllocateInfo allocateInfo{};
+  allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocateInfo.descriptorPool = descriptorPool;
+  allocateInfo.descriptorSetCount = 1;
+  allocateInfo.pSetLayouts = &descriptorSetLayout;
+  validateVkResult(vkAllocateDescriptorSets(mGPU.device, &allocateInfo, &descriptorSet));
+
+  mMaterialBuffer = mMemoryManager.createMappedBuffer(sizeof(MaterialData) * MaxMaterials,
+                                                      VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+
+  VkDescriptorBufferInfo bufferInfo{};
+  bufferInfo.buffer = mMaterialBuffer.buffer;
+  bufferInfo.offset = 0;
+  bufferInfo.range = VK_WHOLE_SIZE;
+
+  VkWriteDescriptorSet writeDescriptorSet{};
+  writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  writeDescriptorSet.dstSet = descriptorSet;
+  writeDescriptorSet.dstBinding = MaterialBinding;
+  writeDescriptorSet.dstArrayElement = 0;
+  writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  writeDescriptorSet.descriptorCount = 1;
+  writeDescriptorSet.pBufferInfo = &bufferInfo;
+  vkUpdateDescriptorSets(mGPU.device, 1, &writeDescriptorSet, 0, nullptr);
+
+  mSpecializationEntry.constantID = 0;
+  mSpecializationEntry.offset = 0;
+  mSpecializationEntry.size = sizeof(textureCapacity);
+
+  mSpecializationInfo.mapEntryCount = 1;
+  mSpecializationInfo.pMapEntries = &mSpecializationEntry;
+  mSpecializationInfo.dataSize = sizeof(textureCapacity);
+  mSpecializationInfo.pData = &textureCapacity;
+}
+
+BindlessTable::~BindlessTable() {
+  mMemoryManager.destroyBuffer(mMaterialBuffer);
+  vkDestroyDescriptorPool(mGPU.device, descriptorPool, nullptr);
+  vkDestroyDescriptorSetLayout(mGPU.device, descriptorSetLayout, nullptr);
+}
+
+uint32_t BindlessTable::getDeviceTextureLimit() const {
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(mGPU.physicalDevice, &properties);
+
+  if (!mGPU.supportsDescriptorIndexing) {
+    return std::min({properties.limits.maxPerStageDescriptorSamplers,
+                     properties.limits.maxPerStageDescriptorSampledImages,
+                     properties.limits.maxDescriptorSetSamplers,
+                     properties.limits.maxDescriptorSetSampledImages});
+  }
+
+  VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+  vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+  VkPhysicalDeviceProperties2 properties2{};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &vulkan12Properties;
+  vkGetPhysicalDeviceProperties2(mGPU.physicalDevice, &properties2);
+
+  return std::min({vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                   vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                   vulkan12Properties.maxDescriptorSetUpdateAfterBindSamplers,
+                   vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages});
+}
+
+void BindlessTable::writeTextureSlots(std::vector<uint32_t> const &slots,
+                                      mem::Texture const &texture) {
+  if (slots.empty()) {
+    return;
+  }
+
+  VkDescriptorImageInfo imageInfo{};
+  imageInfo.imageView = texture.image.imageView;
+  imageInfo.sampler = texture.sampler;
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+  std::vector<VkWriteDescriptorSet> writes(slots.size());
+  for (size_t i = 0; i < slots.size(); i++) {
+    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet = descriptorSet;
+    writes[i].dstBinding = TextureBinding;
+    writes[i].dstArrayElement = slots[i];
+    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[i].descriptorCount = 1;
+    writes[i].pImageInfo = &imageInfo;
+  }
+
+  vkUpdateDescriptorSets(mGPU.device, static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                         nullptr);
+}
+
+void BindlessTable::fillUnusedTextureSlots() {
+  auto const firstTexture =
+      std::find_if(mTextures.begin(), mTextures.end(),
+                   [](mem::Texture const *texture) { return texture != nullptr; });
+  if (firstTexture == mTextures.end()) {
+    // nothing can be drawn without a texture, the stale slots are never read
+    return;
+  }
+
+  std::vector<uint32_t> unusedSlots{};
+  for (uint32_t slot = 0; slot < textureCapacity; slot++) {
+    if (mTextures[slot] == nullptr) {
+      unusedSlots.push_back(slot);
+    }
+  }
+
+  writeTextureSlots(unusedSlots, **firstTexture);
+}
+
+uint32_t BindlessTable::addTexture(mem::Texture const &texture) {
+  auto const unused = std::find(mTextures.begin(), mTextures.end(), nullptr);
+  if (unused == mTextures.end()) {
+    throw std::runtime_error("The bindless texture table is full");
+  }
+  uint32_t const slot = static_cast<uint32_t>(unused - mTextures.begin());
+
+  if (!mGPU.supportsDescriptorIndexing) {
+    // the set may be bound by frames in flight
+    mGPU.waitIdle();
+  }
+
+  mTextures[slot] = &texture;
+  writeTextureSlots({slot}, texture);
+
+  if (!mGPU.supportsDescriptorIndexing) {
+    fillUnusedTextureSlots();
+  }
+
+  return slot;
+}
+
+void BindlessTable::releaseTexture(uint32_t const &index) {
+  mTextures[index] = nullptr;
+
+  if (!mGPU.supportsDescriptorIndexing) {
+    mGPU.waitIdle();
+    fillUnusedTextureSlots();
+  }
+}
+
+uint32_t BindlessTable::addMaterial(MaterialData const &material) {
+  uint32_t slot = 0;
+  if (!mFreeMaterialSlots.empty()) {
+    slot = mFreeMaterialSlots.back();
+    mFreeMaterialSlots.pop_back();
+  } else if (mMaterialCount < MaxMaterials) {
+    slot = mMaterialCount++;
+  } else {
+    throw std::runtime_error("The bindless material table is full");
+  }
+
+  // the buffer is coherent, nothing in flight reads an unused slot
+  std::memcpy(static_cast<MaterialData *>(mMaterialBuffer.mappedData) + slot, &material,
+              sizeof(material));
+
+  return slot;
+}
+
+void BindlessTable::releaseMaterial(uint32_t const &index) { mFreeMaterialSlots.push_back(index); }
+
+VkSpecializationInfo const *BindlessTable::getSpecializationInfo() const {
+  return &mSpecializationInfo;
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Graphics/GPU/GPU.hpp"
+#include "Graphics/Memory/Buffer/Buffer.hpp"
+#include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
+#include "Graphics/Memory/Texture/Texture.hpp"
+
+namespace cbl::gfx {
+// GPU side of a material, mirrors the Material struct of the shaders (std430)
+struct MaterialData {
+  uint32_t textureIndex;
+};
+
+// Single descriptor set shared by every shader. Binding 0 holds every texture in one array, binding
+// 1 is a storage buffer of MaterialData indexing into it. The set is bound once per pipeline, draws
+// only pass the index of their material, as their first instance.
+// With descriptor indexing, unused slots are left unwritten and textures are added while frames are
+// in flight. Without it, every slot must hold a valid texture, so the unused ones repeat the first
+// texture, and adding or releasing one waits for the GPU to be idle
+struct BindlessTable {
+private:
+  GPU const &mGPU;
+  mem::MemoryManager &mMemoryManager;
+
+  mem::Buffer mMaterialBuffer{};
+  uint32_t mMaterialCount = 0;
+  std::vector<uint32_t> mFreeMaterialSlots{};
+
+  std::vector<mem::Texture const *> mTextures{}; // null for unused slots
+
+  VkSpecializationMapEntry mSpecializationEntry{};
+  VkSpecializationInfo mSpecializationInfo{};
+
+  [[nodiscard]] uint32_t getDeviceTextureLimit() const;
+  void writeTextureSlots(std::vector<uint32_t> const &slots, mem::Texture const &texture);
+  void fillUnusedTextureSlots();
+
+public:
+  static constexpr uint32_t MaxTextures = 1024;
+  static constexpr uint32_t MaxMaterials = 4096;
+  static constexpr uint32_t TextureBinding = 0;
+  static constexpr uint32_t MaterialBinding = 1;
+
+  // MaxTextures, or less when the device cannot bind that many
+  uint32_t textureCapacity{};
+
+  VkDescriptorSetLayout descriptorSetLayout{};
+  VkDescriptorPool descriptorPool{};
+  VkDescriptorSet descriptorSet{};
+
+  BindlessTable() = delete;
+  BindlessTable(BindlessTable const &) = delete;
+  BindlessTable(GPU const &gpu, mem::MemoryManager &memoryManager);
+  ~BindlessTable();
+
+  void operator=(BindlessTable const &) = delete;
+
+  // Index of the texture in the shaders' texture array. The texture must stay alive until it is
+  // released, and slots are reused as soon as they are released, so only release what the GPU
+  // does not draw anymore. The same goes for materials
+  [[nodiscard]] uint32_t addTexture(mem::Texture const &texture);
+  void releaseTexture(uint32_t const &index);
+
+  [[nodiscard]] uint32_t addMaterial(MaterialData const &material);
+  void releaseMaterial(uint32_t const &index);
+
+  // specialization constant 0 of the shaders, the size of their texture array
+  [[nodiscard]] VkSpecializationInfo const *getSpecializationInfo() const;
+};
+} // namespace cbl::gfx
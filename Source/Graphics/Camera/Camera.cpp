@@ -10,10 +10,18 @@
 #include "Core/Time/Time.hpp"
 
 namespace cbl::gfx {
-Camera::Camera() {
-  Input::grabCursor();
-  updateVectors();
+
+namespace {
+glm::vec3 getFront(float const &yaw, float const &pitch) {
+  glm::vec3 front;
+  front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+  front.y = sin(glm::radians(pitch));
+  front.z = sin(glm::radians(yaw));
+  return glm::normalize(front);
 }
+} // namespace
+
+Camera::Camera() { updateVectors(); }
 
 Camera::Camera(glm::vec3 const &position, glm::vec3 const &up, float const &yaw, float const &pitch)
     : Camera() {
@@ -21,6 +29,7 @@ Camera::Camera(glm::vec3 const &position, glm::vec3 const &up, float const &yaw,
   mUp = up;
   mYaw = yaw;
   mPitch = pitch;
+  mPreviousPose = getPose();
 }
 
 void Camera::handleMouse() {
@@ -31,7 +40,7 @@ void Camera::handleMouse() {
 }
 
 void Camera::handleKeyboard() {
-  float velocity = Time::deltaSeconds() * mMovementSpeed;
+  float velocity = Time::fixedDeltaSeconds() * mMovementSpeed;
   if (Input::keyPressed("Left Shift"))
     velocity *= 3.0f;
   if (Input::keyPressed("w"))
@@ -49,16 +58,14 @@ void Camera::handleKeyboard() {
 }
 
 void Camera::updateVectors() {
-  glm::vec3 front;
-  front.x = cos(glm::radians(mYaw)) * cos(glm::radians(mPitch));
-  front.y = sin(glm::radians(mPitch));
-  front.z = sin(glm::radians(mYaw));
-  mFront = glm::normalize(front);
+  mFront = getFront(mYaw, mPitch);
   mRight = glm::normalize(glm::cross(mFront, mWorldUp));
   mUp = glm::normalize(glm::cross(mRight, mFront));
 }
 
 void Camera::update() {
+  mPreviousPose = getPose();
+
   if (mControlsEnabled) {
     if (Input::keyPressed("Escape")) {
       Input::releaseCursor();
@@ -76,8 +83,35 @@ void Camera::update() {
   updateVectors();
 }
 
-glm::mat4 Camera::getViewMatrix(float const aspectRatio) const {
-  glm::mat4 const view = lookAt(mPosition, mPosition + mFront, mUp);
+void Camera::setView(glm::vec3 const &position, glm::vec3 const &target) {
+  glm::vec3 const direction = glm::normalize(target - position);
+
+  mPosition = position;
+  mYaw = glm::degrees(std::atan2(direction.z, direction.x));
+  mPitch = std::clamp(glm::degrees(std::asin(direction.y)), -89.0f, 89.0f);
+  mPreviousPose = getPose();
+
+  updateVectors();
+}
+
+void Camera::setPose(CameraPose const &pose) {
+  mPosition = pose.position;
+  mYaw = pose.yaw;
+  mPitch = pose.pitch;
+  mPreviousPose = pose;
+
+  updateVectors();
+}
+
+CameraPose Camera::getPose() const { return CameraPose{mPosition, mYaw, mPitch}; }
+
+glm::mat4 Camera::getViewMatrix(float const aspectRatio, float const alpha) const {
+  glm::vec3 const position = glm::mix(mPreviousPose.position, mPosition, alpha);
+  glm::vec3 const front = getFront(glm::mix(mPreviousPose.yaw, mYaw, alpha),
+                                   glm::mix(mPreviousPose.pitch, mPitch, alpha));
+  glm::vec3 const up = glm::normalize(glm::cross(glm::cross(front, mWorldUp), front));
+
+  glm::mat4 const view = lookAt(position, position + front, up);
   glm::mat4 projection = glm::perspective(glm::radians(mFov), aspectRatio, mNearClip, mFarClip);
 
   projection[1][1] *= -1;
@@ -6,6 +6,12 @@
 #include "Math/Vector/Vector2/Vector2.hpp"
 
 namespace cbl::gfx {
+struct CameraPose {
+  glm::vec3 position;
+  float yaw;
+  float pitch;
+};
+
 struct Camera {
 private:
   glm::vec3 mPosition = glm::vec3(0.0f, 0.0f, -2.0f);
@@ -17,6 +23,9 @@ private:
   float mYaw = 90.0f;
   float mPitch = 0.0f;
 
+  // pose before the last simulation step, rendering blends from it towards the current pose
+  CameraPose mPreviousPose{mPosition, mYaw, mPitch};
+
   float mFov = 90.0f;
   float mNearClip = 0.01f;
   float mFarClip = 500.0f;
@@ -31,12 +40,20 @@ private:
   void updateVectors();
 
 public:
+  // does not grab the cursor, whoever hands the controls to the player does
   Camera();
   Camera(glm::vec3 const &position, glm::vec3 const &up, float const &yaw, float const &pitch);
 
+  // called once per simulation step
   void update();
+  // places the camera at position, looking at target
+  void setView(glm::vec3 const &position, glm::vec3 const &target);
+  void setPose(CameraPose const &pose);
+
+  [[nodiscard]] CameraPose getPose() const;
 
-  [[nodiscard]] glm::mat4 getViewMatrix(float aspectRatio) const;
+  // alpha interpolates between the previous and the current simulation step
+  [[nodiscard]] glm::mat4 getViewMatrix(float aspectRatio, float alpha = 1.0f) const;
 };
 
 } // namespace cbl::gfx
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "CameraPath.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace cbl::gfx {
+
+namespace {
+template <typename T> void writeValue(std::ofstream &stream, T const &value) {
+  stream.write(reinterpret_cast<char const *>(&value), sizeof(T));
+}
+
+template <typename T> T readValue(std::ifstream &stream) {
+  T value{};
+  stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+  return value;
+}
+} // namespace
+
+void CameraPath::record(Camera const &camera, float const &deltaSeconds) {
+  if (poses.empty()) {
+    poses.push_back(camera.getPose());
+    return;
+  }
+
+  // the pose only changes once per frame, slow frames repeat it for every tick they cover
+  mUnrecordedSeconds += deltaSeconds;
+  float const tickSeconds = 1.0f / tickRate;
+
+  while (mUnrecordedSeconds >= tickSeconds) {
+    poses.push_back(camera.getPose());
+    mUnrecordedSeconds -= tickSeconds;
+  }
+}
+
+void CameraPath::save(std::filesystem::path const &path) const {
+  std::ofstream stream{path, std::ios::binary};
+  if (!stream) {
+    throw std::runtime_error("Failed to open camera path file for writing : " + path.string());
+  }
+
+  // header, followed by 5 floats per pose
+  stream.write(mMagic, sizeof(mMagic));
+  writeValue(stream, mVersion);
+  writeValue(stream, tickRate);
+  writeValue(stream, static_cast<uint32_t>(poses.size()));
+
+  for (CameraPose const &pose : poses) {
+    writeValue(stream, pose.position.x);
+    writeValue(stream, pose.position.y);
+    writeValue(stream, pose.position.z);
+    writeValue(stream, pose.yaw);
+    writeValue(stream, pose.pitch);
+  }
+}
+
+CameraPath CameraPath::load(std::filesystem::path const &path) {
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) {
+    throw std::runtime_error("Failed to open camera path file : " + path.string());
+  }
+
+  char magic[sizeof(mMagic)]{};
+  stream.read(magic, sizeof(magic));
+  uint32_t const version = readValue<uint32_t>(stream);
+
+  if (!stream || std::memcmp(magic, mMagic, sizeof(mMagic)) != 0 || version != mVersion) {
+    throw std::runtime_error("Not a camera path file : " + path.string());
+  }
+
+  CameraPath cameraPath{};
+  cameraPath.tickRate = readValue<float>(stream);
+  uint32_t const poseCount = readValue<uint32_t>(stream);
+
+  if (!(cameraPath.tickRate > 0.0f)) {
+    throw std::runtime_error("Invalid tick rate in camera path file : " + path.string());
+  }
+
+  for (uint32_t i = 0; i < poseCount && stream; i++) {
+    CameraPose pose{};
+    pose.position.x = readValue<float>(stream);
+    pose.position.y = readValue<float>(stream);
+    pose.position.z = readValue<float>(stream);
+    pose.yaw = readValue<float>(stream);
+    pose.pitch = readValue<float>(stream);
+    cameraPath.poses.push_back(pose);
+  }
+
+  if (!stream) {
+    throw std::runtime_error("Truncated camera path file : " + path.string());
+  }
+
+  return cameraPath;
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "Graphics/Camera/Camera.hpp"
+
+namespace cbl::gfx {
+// Camera poses sampled at a fixed tick rate. Replaying a path shows pose i on frame i, so every
+// run renders the same views no matter how fast the machine is
+struct CameraPath {
+private:
+  static constexpr char mMagic[4] = {'C', 'B', 'L', 'P'};
+  static constexpr uint32_t mVersion = 1;
+
+  float mUnrecordedSeconds = 0.0f;
+
+public:
+  static constexpr float DefaultTickRate = 60.0f;
+
+  float tickRate = DefaultTickRate;
+  std::vector<CameraPose> poses{};
+
+  // samples the camera once for every tick elapsed during deltaSeconds
+  void record(Camera const &camera, float const &deltaSeconds);
+
+  void save(std::filesystem::path const &path) const;
+  [[nodiscard]] static CameraPath load(std::filesystem::path const &path);
+};
+} // namespace cbl::gfx
@@ -0,0 +1,30 @@
+#include "Frustum.hpp"
+
+namespace cbl::gfx {
+
+Frustum::Frustum(glm::mat4 const &viewProjection) {
+  // glm is column major, transposing gives the rows of the matrix
+  glm::mat4 const rows = glm::transpose(viewProjection);
+
+  mPlanes[0] = rows[3] + rows[0]; // left
+  mPlanes[1] = rows[3] - rows[0]; // right
+  mPlanes[2] = rows[3] + rows[1]; // bottom, top once y is flipped
+  mPlanes[3] = rows[3] - rows[1];
+  mPlanes[4] = rows[3] + rows[2]; // near, also correct when depth goes from 0 to 1, only looser
+  mPlanes[5] = rows[3] - rows[2]; // far
+
+  for (glm::vec4 &plane : mPlanes) {
+    plane /= glm::length(glm::vec3{plane});
+  }
+}
+
+bool Frustum::intersectsSphere(glm::vec3 const &center, float const &radius) const {
+  for (glm::vec4 const &plane : mPlanes) {
+    if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
+} // namespace cbl::gfx
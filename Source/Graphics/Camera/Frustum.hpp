@@ -0,0 +1,21 @@
+#pragma once
+
+#include <array>
+
+#include <glm/glm.hpp>
+
+namespace cbl::gfx {
+// Planes of a camera's view volume, extracted from its view projection matrix
+struct Frustum {
+private:
+  // xyz is the unit normal, pointing inside the volume, w the distance from the origin
+  std::array<glm::vec4, 6> mPlanes{};
+
+public:
+  Frustum() = delete;
+  explicit Frustum(glm::mat4 const &viewProjection);
+
+  // conservative, a sphere near a corner may pass without being visible
+  [[nodiscard]] bool intersectsSphere(glm::vec3 const &center, float const &radius) const;
+};
+} // namespace cbl::gfx
@@ -1,5 +1,6 @@
 #include "CommandBufferRecorder.hpp"
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 
@@ -26,6 +27,40 @@ CommandBufferRecorder &CommandBufferRecorder::beginOneTime() {
   return *this;
 }
 
+CommandBufferRecorder &CommandBufferRecorder::beginSecondary(VkRenderPass const &renderPass,
+                                                             VkFramebuffer const &framebuffer) {
+  VkCommandBufferInheritanceInfo inheritanceInfo{};
+  inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass = renderPass;
+  inheritanceInfo.subpass = 0;
+  inheritanceInfo.framebuffer = framebuffer;
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                    VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+  validateVkResult(vkBeginCommandBuffer(mCommandBuffer, &beginInfo));
+  return *this;
+}
+
+CommandBufferRecorder &CommandBufferRecorder::beginProfiling(GpuProfiler &profiler) {
+  profiler.beginBatch(mCommandBuffer);
+  return *this;
+}
+
+CommandBufferRecorder &CommandBufferRecorder::beginProfileScope(GpuProfiler &profiler,
+                                                                std::string const &name) {
+  profiler.beginScope(mCommandBuffer, name);
+  return *this;
+}
+
+CommandBufferRecorder &CommandBufferRecorder::endProfileScope(GpuProfiler &profiler) {
+  profiler.endScope(mCommandBuffer);
+  return *this;
+}
+
 CommandBufferRecorder &CommandBufferRecorder::copyBuffer(mem::Buffer const &src,
                                                          mem::Buffer const &dst) {
   if (!src.isValid || !dst.isValid) {
@@ -61,7 +96,8 @@ CommandBufferRecorder::addMeshBufferMemoryBarrier(mem::Buffer const &buffer,
 
 CommandBufferRecorder &CommandBufferRecorder::transitionImageLayout(
     mem::Image const &image, VkImageLayout const &oldLayout, VkImageLayout const &newLayout,
-    QueueFamilyIndices const &queueFamilyIndices) {
+    QueueFamilyIndices const &queueFamilyIndices, uint32_t const &baseMipLevel,
+    uint32_t const &levelCount) {
 
   VkImageMemoryBarrier barrier{};
   barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -71,8 +107,8 @@ CommandBufferRecorder &CommandBufferRecorder::transitionImageLayout(
   barrier.dstQueueFamilyIndex = queueFamilyIndices.transfer;
   barrier.image = image.image;
   barrier.subresourceRange.aspectMask = image.aspect;
-  barrier.subresourceRange.baseMipLevel = 0;
-  barrier.subresourceRange.levelCount = 1;
+  barrier.subresourceRange.baseMipLevel = baseMipLevel;
+  barrier.subresourceRange.levelCount = levelCount;
   barrier.subresourceRange.baseArrayLayer = 0;
   barrier.subresourceRange.layerCount = image.layers;
 
@@ -92,6 +128,22 @@ CommandBufferRecorder &CommandBufferRecorder::transitionImageLayout(
 
     sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
     destinationStage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+  } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
+             newLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+    // a mip level that was just written is read to fill the next one
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+    sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL &&
+             newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+    // only recorded on the graphics queue, which has a fragment stage to wait on
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
   } else {
     throw std::invalid_argument("unsupported layout transition!");
   }
@@ -104,19 +156,66 @@ CommandBufferRecorder &CommandBufferRecorder::transitionImageLayout(
 
 CommandBufferRecorder &CommandBufferRecorder::copyBufferToImage(mem::Buffer const &src,
                                                                 mem::Image const &dst) {
-  VkBufferImageCopy region{};
-  region.bufferOffset = 0;
-  region.bufferRowLength = 0;
-  region.bufferImageHeight = 0;
-  region.imageSubresource.aspectMask = dst.aspect;
-  region.imageSubresource.mipLevel = 0;
-  region.imageSubresource.baseArrayLayer = 0;
-  region.imageSubresource.layerCount = dst.layers;
-  region.imageOffset = {0, 0, 0};
-  region.imageExtent = {dst.extent.width, dst.extent.height, 1};
+  return copyBufferToImage(src, dst, {0});
+}
+
+CommandBufferRecorder &
+CommandBufferRecorder::copyBufferToImage(mem::Buffer const &src, mem::Image const &dst,
+                                         std::vector<VkDeviceSize> const &levelOffsets) {
+  std::vector<VkBufferImageCopy> regions(levelOffsets.size());
+  for (uint32_t level = 0; level < regions.size(); level++) {
+    VkBufferImageCopy &region = regions[level];
+    region.bufferOffset = levelOffsets[level];
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = dst.aspect;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = dst.layers;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {std::max(dst.extent.width >> level, 1u),
+                          std::max(dst.extent.height >> level, 1u), 1};
+  }
 
   vkCmdCopyBufferToImage(mCommandBuffer, src.buffer, dst.image,
-                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                         static_cast<uint32_t>(regions.size()), regions.data());
+
+  return *this;
+}
+
+CommandBufferRecorder &
+CommandBufferRecorder::generateMipmaps(mem::Image const &image,
+                                       QueueFamilyIndices const &queueFamilyIndices) {
+  for (uint32_t level = 1; level < image.mipLevels; level++) {
+    transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, queueFamilyIndices, level - 1, 1);
+
+    int32_t const sourceWidth =
+        static_cast<int32_t>(std::max(image.extent.width >> (level - 1), 1u));
+    int32_t const sourceHeight =
+        static_cast<int32_t>(std::max(image.extent.height >> (level - 1), 1u));
+
+    std::vector<VkImageBlit> regions(image.layers);
+    for (uint32_t layer = 0; layer < image.layers; layer++) {
+      VkImageBlit &region = regions[layer];
+      region.srcSubresource = {image.aspect, level - 1, layer, 1};
+      region.srcOffsets[1] = {sourceWidth, sourceHeight, 1};
+      region.dstSubresource = {image.aspect, level, layer, 1};
+      region.dstOffsets[1] = {std::max(sourceWidth / 2, 1), std::max(sourceHeight / 2, 1), 1};
+    }
+
+    vkCmdBlitImage(mCommandBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.image,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()),
+                   regions.data(), VK_FILTER_LINEAR);
+  }
+
+  // the last level was never read, the whole image then goes from one layout to the shader's
+  transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, queueFamilyIndices,
+                        image.mipLevels - 1, 1);
+  transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, queueFamilyIndices);
 
   return *this;
 }
@@ -142,7 +241,8 @@ CommandBufferRecorder &CommandBufferRecorder::setScissor(VkRect2D const &scissor
 
 CommandBufferRecorder &CommandBufferRecorder::beginRenderPass(VkRenderPass const &renderPass,
                                                               VkFramebuffer const &framebuffer,
-                                                              VkRect2D const &renderArea) {
+                                                              VkRect2D const &renderArea,
+                                                              VkSubpassContents const &contents) {
   std::array<VkClearValue, 2> clearValues{};
   clearValues[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
   clearValues[1].depthStencil = {1.0f, 0};
@@ -155,23 +255,17 @@ CommandBufferRecorder &CommandBufferRecorder::beginRenderPass(VkRenderPass const
   renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
   renderPassBeginInfo.pClearValues = clearValues.data();
 
-  vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+  vkCmdBeginRenderPass(mCommandBuffer, &renderPassBeginInfo, contents);
 
   return *this;
 }
 
-CommandBufferRecorder &CommandBufferRecorder::pushCameraView(glm::mat4 const &view,
-                                                             BaseShader const &shader) {
-  vkCmdPushConstants(mCommandBuffer, shader.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
-                     sizeof(glm::mat4), &view);
-
-  return *this;
-}
-
-CommandBufferRecorder &CommandBufferRecorder::pushModelPosition(glm::mat4 const &position,
-                                                                BaseShader const &shader) {
-  vkCmdPushConstants(mCommandBuffer, shader.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
-                     sizeof(glm::mat4), sizeof(glm::mat4), &position);
+CommandBufferRecorder &
+CommandBufferRecorder::executeCommands(std::vector<VkCommandBuffer> const &commandBuffers) {
+  if (!commandBuffers.empty()) {
+    vkCmdExecuteCommands(mCommandBuffer, static_cast<uint32_t>(commandBuffers.size()),
+                         commandBuffers.data());
+  }
 
   return *this;
 }
@@ -181,15 +275,23 @@ CommandBufferRecorder &CommandBufferRecorder::bindGraphicsShader(BaseShader cons
   return *this;
 }
 
-CommandBufferRecorder &CommandBufferRecorder::bindMaterial(BaseShader const &shader,
-                                                           BaseMaterial const &material) {
+CommandBufferRecorder &
+CommandBufferRecorder::bindBindlessTable(BaseShader const &shader,
+                                         BindlessTable const &bindlessTable) {
   vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader.pipelineLayout, 0,
-                          static_cast<uint32_t>(material.descriptorSets.size()),
-                          material.descriptorSets.data(), 0, nullptr);
+                          1, &bindlessTable.descriptorSet, 0, nullptr);
   return *this;
 }
 
-CommandBufferRecorder &CommandBufferRecorder::drawMesh(Mesh const &mesh) {
+CommandBufferRecorder &CommandBufferRecorder::bindDrawData(BaseShader const &shader,
+                                                           VkDescriptorSet const &drawDataSet) {
+  vkCmdBindDescriptorSets(mCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, shader.pipelineLayout,
+                          DrawDataTable::SetIndex, 1, &drawDataSet, 0, nullptr);
+  return *this;
+}
+
+CommandBufferRecorder &CommandBufferRecorder::drawMesh(Mesh const &mesh,
+                                                       uint32_t const &firstInstance) {
   if (!mesh.buffer.isValid) {
     return *this;
   }
@@ -199,7 +301,8 @@ CommandBufferRecorder &CommandBufferRecorder::drawMesh(Mesh const &mesh) {
   std::array<VkDeviceSize, 1> vertexBufferOffset{mesh.getIndicesSize()};
   vkCmdBindVertexBuffers(mCommandBuffer, 0, 1, &mesh.buffer.buffer, vertexBufferOffset.data());
 
-  vkCmdDrawIndexed(mCommandBuffer, static_cast<uint32_t>(mesh.indices.size()), 1, 0, 0, 0);
+  vkCmdDrawIndexed(mCommandBuffer, static_cast<uint32_t>(mesh.indices.size()), 1, 0, 0,
+                   firstInstance);
   return *this;
 }
 
@@ -213,13 +316,9 @@ CommandBufferRecorder &CommandBufferRecorder::end() {
   return *this;
 }
 
-void CommandBufferRecorder::submit(VkQueue const &submitQueue, VkFence const &fence) {
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &mCommandBuffer;
-
-  vkQueueSubmit(submitQueue, 1, &submitInfo, fence);
+uint64_t CommandBufferRecorder::submit(Timeline &timeline, std::vector<Timeline::Wait> const &waits,
+                                       std::vector<VkSemaphore> const &signalSemaphores) {
+  return timeline.submit(mCommandBuffer, waits, signalSemaphores);
 }
 
 } // namespace cbl::gfx
\ No newline at end of file
@@ -4,11 +4,14 @@
 
 #include <vulkan/vulkan.h>
 
-#include "Graphics/Materials/BaseMaterial.hpp"
+#include "Graphics/Bindless/BindlessTable.hpp"
+#include "Graphics/DrawData/DrawDataTable.hpp"
 #include "Graphics/Memory/Buffer/Buffer.hpp"
 #include "Graphics/Mesh/Mesh.hpp"
+#include "Graphics/Profiler/GpuProfiler.hpp"
 #include "Graphics/Shaders/BaseShader.hpp"
 #include "Graphics/Swapchain/Swapchain.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
 
 namespace cbl::gfx {
 struct CommandBufferRecorder {
@@ -20,30 +23,55 @@ public:
 
   CommandBufferRecorder &begin();
   CommandBufferRecorder &beginOneTime();
+  // for secondary command buffers executed inside the first subpass of renderPass
+  CommandBufferRecorder &beginSecondary(VkRenderPass const &renderPass,
+                                        VkFramebuffer const &framebuffer);
+
+  CommandBufferRecorder &beginProfiling(GpuProfiler &profiler);
+  CommandBufferRecorder &beginProfileScope(GpuProfiler &profiler, std::string const &name);
+  CommandBufferRecorder &endProfileScope(GpuProfiler &profiler);
 
   CommandBufferRecorder &copyBuffer(mem::Buffer const &src, mem::Buffer const &dst);
   CommandBufferRecorder &addMeshBufferMemoryBarrier(mem::Buffer const &buffer,
                                                     QueueFamilyIndices const &queueFamilyIndices);
 
+  // covers every layer of levelCount mip levels, from baseMipLevel
   CommandBufferRecorder &transitionImageLayout(mem::Image const &image,
                                                VkImageLayout const &oldLayout,
                                                VkImageLayout const &newLayout,
-                                               QueueFamilyIndices const &queueFamilyIndices);
+                                               QueueFamilyIndices const &queueFamilyIndices,
+                                               uint32_t const &baseMipLevel = 0,
+                                               uint32_t const &levelCount =
+                                                   VK_REMAINING_MIP_LEVELS);
   CommandBufferRecorder &copyBufferToImage(mem::Buffer const &src, mem::Image const &dst);
+  // one region per mip level, each holding every layer of that level
+  CommandBufferRecorder &copyBufferToImage(mem::Buffer const &src, mem::Image const &dst,
+                                           std::vector<VkDeviceSize> const &levelOffsets);
+  // Fills every mip level from level 0 with a chain of linear blits, one region per layer. Every
+  // level must be in TRANSFER_DST_OPTIMAL, and they all end up in SHADER_READ_ONLY_OPTIMAL. Blits
+  // need a graphics queue
+  CommandBufferRecorder &generateMipmaps(mem::Image const &image,
+                                         QueueFamilyIndices const &queueFamilyIndices);
 
   CommandBufferRecorder &setViewPort(VkExtent2D const &viewportExtent);
   CommandBufferRecorder &setScissor(VkRect2D const &scissorRect);
   CommandBufferRecorder &beginRenderPass(VkRenderPass const &renderPass,
                                          VkFramebuffer const &frameBuffer,
-                                         VkRect2D const &renderArea);
-  CommandBufferRecorder &pushCameraView(glm::mat4 const &view, BaseShader const &shader);
-  CommandBufferRecorder &pushModelPosition(glm::mat4 const &position, BaseShader const &shader);
+                                         VkRect2D const &renderArea,
+                                         VkSubpassContents const &contents =
+                                             VK_SUBPASS_CONTENTS_INLINE);
+  CommandBufferRecorder &executeCommands(std::vector<VkCommandBuffer> const &commandBuffers);
   CommandBufferRecorder &bindGraphicsShader(BaseShader const &shader);
-  CommandBufferRecorder &bindMaterial(BaseShader const &shader, BaseMaterial const &material);
-  CommandBufferRecorder &drawMesh(Mesh const &mesh);
+  CommandBufferRecorder &bindBindlessTable(BaseShader const &shader,
+                                           BindlessTable const &bindlessTable);
+  // one of the sets of a DrawDataTable
+  CommandBufferRecorder &bindDrawData(BaseShader const &shader, VkDescriptorSet const &drawDataSet);
+  // firstInstance reaches the shaders as gl_InstanceIndex
+  CommandBufferRecorder &drawMesh(Mesh const &mesh, uint32_t const &firstInstance = 0);
   CommandBufferRecorder &endRenderPass();
 
   CommandBufferRecorder &end();
-  void submit(VkQueue const &submitQueue, VkFence const &fence = VK_NULL_HANDLE);
+  uint64_t submit(Timeline &timeline, std::vector<Timeline::Wait> const &waits = {},
+                  std::vector<VkSemaphore> const &signalSemaphores = {});
 };
 } // namespace cbl::gfx
\ No newline at end of file
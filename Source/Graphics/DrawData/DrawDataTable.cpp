@@ -0,0 +1,129 @@
+#include "DrawDataTable.hpp"
+
+#include <algorithm>
+
+#include "Graphics/Utils/VulkanHelpers.hpp"
+
+namespace cbl::gfx {
+
+DrawDataTable::DrawDataTable(GPU const &gpu, mem::MemoryManager &memoryManager)
+    : mGPU{gpu}, mMemoryManager{memoryManager} {
+  std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+  bindings[CameraBinding].binding = CameraBinding;
+  bindings[CameraBinding].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  bindings[CameraBinding].descriptorCount = 1;
+  bindings[CameraBinding].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+  bindings[DrawBinding].binding = DrawBinding;
+  bindings[DrawBinding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  bindings[DrawBinding].descriptorCount = 1;
+  bindings[DrawBinding].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+  VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo{};
+  descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+  descriptorSetLayoutCreateInfo.pBindings = bindings.data();
+  validateVkResult(vkCreateDescriptorSetLayout(mGPU.device, &descriptorSetLayoutCreateInfo, nullptr,
+                                               &descriptorSetLayout));
+
+  auto const slotCount = static_cast<uint32_t>(mFrameSlots.size());
+  std::array<VkDescriptorPoolSize, 2> poolSizes{
+      VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, slotCount},
+      VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, slotCount}};
+
+  VkDescriptorPoolCreateInfo descriptorPoolCreateInfo{};
+  descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+  descriptorPoolCreateInfo.pPoolSizes = poolSizes.data();
+  descriptorPoolCreateInfo.maxSets = slotCount;
+  validateVkResult(
+      vkCreateDescriptorPool(mGPU.device, &descriptorPoolCreateInfo, nullptr, &descriptorPool));
+
+  std::array<VkDescriptorSetLayout, EngineConfig::MaxFramesInFlight> layouts{};
+  layouts.fill(descriptorSetLayout);
+  std::array<VkDescriptorSet, EngineConfig::MaxFramesInFlight> descriptorSets{};
+
+  VkDescriptorSetAllocateInfo allocateInfo{};
+  allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  allocateInfo.descriptorPool = descriptorPool;
+  allocateInfo.descriptorSetCount = slotCount;
+  allocateInfo.pSetLayouts = layouts.data();
+  validateVkResult(vkAllocateDescriptorSets(mGPU.device, &allocateInfo, descriptorSets.data()));
+
+  for (size_t i = 0; i < mFrameSlots.size(); i++) {
+    FrameSlot &slot = mFrameSlots[i];
+    slot.descriptorSet = descriptorSets[i];
+    slot.cameraBuffer =
+        mMemoryManager.createMappedBuffer(sizeof(CameraData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+    slot.drawCapacity = mMinDrawCapacity;
+    slot.drawBuffer = mMemoryManager.createMappedBuffer(sizeof(DrawData) * slot.drawCapacity,
+                                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    writeDescriptorSet(slot);
+  }
+}
+
+DrawDataTable::~DrawDataTable() {
+  for (FrameSlot &slot : mFrameSlots) {
+    mMemoryManager.destroyBuffer(slot.cameraBuffer);
+    mMemoryManager.destroyBuffer(slot.drawBuffer);
+  }
+
+  vkDestroyDescriptorPool(mGPU.device, descriptorPool, nullptr);
+  vkDestroyDescriptorSetLayout(mGPU.device, descriptorSetLayout, nullptr);
+}
+
+void DrawDataTable::writeDescriptorSet(FrameSlot const &slot) const {
+  VkDescriptorBufferInfo cameraBufferInfo{};
+  cameraBufferInfo.buffer = slot.cameraBuffer.buffer;
+  cameraBufferInfo.offset = 0;
+  cameraBufferInfo.range = VK_WHOLE_SIZE;
+
+  VkDescriptorBufferInfo drawBufferInfo{};
+  drawBufferInfo.buffer = slot.drawBuffer.buffer;
+  drawBufferInfo.offset = 0;
+  drawBufferInfo.range = VK_WHOLE_SIZE;
+
+  std::array<VkWriteDescriptorSet, 2> writes{};
+  writes[CameraBinding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  writes[CameraBinding].dstSet = slot.descriptorSet;
+  writes[CameraBinding].dstBinding = CameraBinding;
+  writes[CameraBinding].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  writes[CameraBinding].descriptorCount = 1;
+  writes[CameraBinding].pBufferInfo = &cameraBufferInfo;
+
+  writes[DrawBinding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  writes[DrawBinding].dstSet = slot.descriptorSet;
+  writes[DrawBinding].dstBinding = DrawBinding;
+  writes[DrawBinding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  writes[DrawBinding].descriptorCount = 1;
+  writes[DrawBinding].pBufferInfo = &drawBufferInfo;
+
+  vkUpdateDescriptorSets(mGPU.device, static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                         nullptr);
+}
+
+void DrawDataTable::setCamera(uint32_t const &frameIndex, glm::mat4 const &viewProjection) {
+  CameraData const cameraData{viewProjection};
+  *static_cast<CameraData *>(mFrameSlots.at(frameIndex).cameraBuffer.mappedData) = cameraData;
+}
+
+DrawData *DrawDataTable::reserveDraws(uint32_t const &frameIndex, size_t const &drawCount) {
+  FrameSlot &slot = mFrameSlots.at(frameIndex);
+
+  if (drawCount > slot.drawCapacity) {
+    // the set was only used by the frame's previous submission, which is complete
+    mMemoryManager.destroyBuffer(slot.drawBuffer);
+    slot.drawCapacity = std::max(drawCount, slot.drawCapacity * 2);
+    slot.drawBuffer = mMemoryManager.createMappedBuffer(sizeof(DrawData) * slot.drawCapacity,
+                                                        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    writeDescriptorSet(slot);
+  }
+
+  return static_cast<DrawData *>(slot.drawBuffer.mappedData);
+}
+
+VkDescriptorSet const &DrawDataTable::getDescriptorSet(uint32_t const &frameIndex) const {
+  return mFrameSlots.at(frameIndex).descriptorSet;
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include "Graphics/Engine/EngineConfig.hpp"
+#include "Graphics/GPU/GPU.hpp"
+#include "Graphics/Memory/Buffer/Buffer.hpp"
+#include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
+
+namespace cbl::gfx {
+// mirrors the Camera uniform block of the shaders (std140)
+struct CameraData {
+  glm::mat4 viewProjection;
+};
+
+// mirrors the Draw struct of the shaders (std430)
+struct DrawData {
+  glm::vec3 origin;
+  uint32_t materialIndex; // into the bindless table
+  uint32_t lod;           // always 0 until chunks get levels of detail
+  uint32_t padding[3];
+};
+static_assert(sizeof(DrawData) == 32, "DrawData must match the std430 layout of the shaders");
+
+// Per frame descriptor set, bound next to the bindless table. Binding 0 is a uniform buffer with
+// the camera, binding 1 a storage buffer with one DrawData per draw of the frame, that the shaders
+// index with the draw's first instance. Both buffers stay mapped, and each frame in flight has its
+// own so they are only written once the GPU is done with that frame
+struct DrawDataTable {
+private:
+  struct FrameSlot {
+    mem::Buffer cameraBuffer{};
+    mem::Buffer drawBuffer{};
+    size_t drawCapacity = 0;
+    VkDescriptorSet descriptorSet{};
+  };
+
+  static constexpr size_t mMinDrawCapacity = 1024;
+
+  GPU const &mGPU;
+  mem::MemoryManager &mMemoryManager;
+
+  std::array<FrameSlot, EngineConfig::MaxFramesInFlight> mFrameSlots{};
+
+  void writeDescriptorSet(FrameSlot const &slot) const;
+
+public:
+  static constexpr uint32_t SetIndex = 1;
+  static constexpr uint32_t CameraBinding = 0;
+  static constexpr uint32_t DrawBinding = 1;
+
+  VkDescriptorSetLayout descriptorSetLayout{};
+  VkDescriptorPool descriptorPool{};
+
+  DrawDataTable() = delete;
+  DrawDataTable(DrawDataTable const &) = delete;
+  DrawDataTable(GPU const &gpu, mem::MemoryManager &memoryManager);
+  ~DrawDataTable();
+
+  void operator=(DrawDataTable const &) = delete;
+
+  // the GPU must be done with the frame's previous submission
+  void setCamera(uint32_t const &frameIndex, glm::mat4 const &viewProjection);
+  // Room for drawCount draws of the frame, valid until the next call for the same frame. The
+  // buffer grows when it is too small, the GPU must be done with the frame's previous submission
+  [[nodiscard]] DrawData *reserveDraws(uint32_t const &frameIndex, size_t const &drawCount);
+
+  [[nodiscard]] VkDescriptorSet const &getDescriptorSet(uint32_t const &frameIndex) const;
+};
+} // namespace cbl::gfx
@@ -1,26 +1,75 @@
 ﻿#include "Engine.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+
+#include <glm/gtc/constants.hpp>
+
 #include "External/imgui/backends/imgui_impl_vulkan.h"
 #include "External/imgui/imgui.h"
 
+#include "Core/Input/Input.hpp"
+#include "Core/Time/StartupTimer.hpp"
 #include "Core/Time/Time.hpp"
+#include "Core/Trace/Trace.hpp"
+#include "Graphics/Camera/Frustum.hpp"
 #include "Graphics/CommandBufferRecorder/CommandBufferRecorder.hpp"
 #include "Graphics/Materials/ChunkMaterial/ChunkMaterial.hpp"
 #include "Graphics/Shaders/ChunkShader/ChunkShader.hpp"
 #include "Graphics/Utils/VulkanHelpers.hpp"
 
 namespace cbl::gfx {
-Engine::Engine()
-    : mWindow{}, mGPU{mWindow}, mMemoryManager{mGPU},
-      mSwapchain{mGPU, mWindow, mMemoryManager}, mFrames{Frame{mGPU}, Frame{mGPU}} {
+Engine::Engine(jobs::Scheduler &jobs, EngineConfig const &config)
+    : mConfig{config.clamped()}, mPendingConfig{mConfig}, mJobs{jobs},
+      mWindow{mConfig.headless ? nullptr : std::make_unique<Window>()}, mGPU{mWindow.get()},
+      mGraphicsTimeline{mGPU, mGPU.graphicsQueue}, mMemoryManager{mGPU},
+      mBindlessTable{mGPU, mMemoryManager}, mDrawDataTable{mGPU, mMemoryManager},
+      mResidency{mMemoryManager, mGraphicsTimeline,
+                 static_cast<float>(mConfig.memoryBudgetPercent) / 100.0f},
+      mMemoryTelemetry{mMemoryManager, mResidency, mConfig.memoryLogSeconds},
+      mGpuProfiler{mGPU, mGraphicsTimeline, mGPU.queueFamilyIndices.graphics},
+      mPipelineCache{mGPU},
+      mSwapchain{mGPU, mWindow.get(), mMemoryManager, mGraphicsTimeline, mConfig} {
+
+  {
+    StartupTimer::Phase phase{"Frame resources"};
+    createFrames();
+  }
 
-  mState.currentFrame = &mFrames[mState.currentFrameNumber];
-  initImgui();
+  if (mWindow) {
+    StartupTimer::Phase phase{"ImGui initialization"};
+    initImgui();
+  }
 }
 
 Engine::~Engine() {
-  vkDestroyDescriptorPool(mGPU.device, imguiPool, nullptr);
-  ImGui_ImplVulkan_Shutdown();
+  stopSimulation();
+
+  if (mWindow) {
+    vkDestroyDescriptorPool(mGPU.device, imguiPool, nullptr);
+    ImGui_ImplVulkan_Shutdown();
+  }
+}
+
+void Engine::createFrames() {
+  // frames still referenced by the GPU cannot be destroyed
+  mGPU.waitIdle();
+
+  mFrames.clear();
+  for (unsigned int i = 0; i < mConfig.framesInFlight; i++) {
+    // the main thread records too while it waits for the workers
+    mFrames.push_back(std::make_unique<Frame>(mGPU, mJobs.getWorkerCount() + 1));
+  }
+
+  mState.currentFrameNumber = 0;
+  mState.currentFrame = mFrames[mState.currentFrameNumber].get();
 }
 
 void Engine::initImgui() {
@@ -48,139 +97,666 @@ void Engine::initImgui() {
 
   // 2: initialize imgui library
   ImGui::CreateContext();
-  mWindow.initImgui();
+  mWindow->initImgui();
 
   ImGui_ImplVulkan_InitInfo init_info = {};
   init_info.Instance = mGPU.instance;
   init_info.PhysicalDevice = mGPU.physicalDevice;
   init_info.Device = mGPU.device;
   init_info.Queue = mGPU.graphicsQueue;
+  init_info.PipelineCache = mPipelineCache.pipelineCache;
   init_info.DescriptorPool = imguiPool;
   init_info.MinImageCount = static_cast<uint32_t>(mSwapchain.frameBufferImages.size());
-  init_info.ImageCount = static_cast<uint32_t>(mSwapchain.frameBufferImages.size());
+  // imgui cycles through ImageCount vertex buffers, one per frame that can still be in flight
+  init_info.ImageCount = std::max(static_cast<uint32_t>(mSwapchain.frameBufferImages.size()),
+                                  EngineConfig::MaxFramesInFlight);
 
   ImGui_ImplVulkan_Init(&init_info, mSwapchain.renderPass);
 
   CommandBufferRecorder recorder{mState.currentFrame->commandBuffer};
   recorder.beginOneTime();
   ImGui_ImplVulkan_CreateFontsTexture(mState.currentFrame->commandBuffer);
-  recorder.end().submit(mGPU.graphicsQueue);
+  mState.currentFrame->renderFinishedValue = recorder.end().submit(mGraphicsTimeline);
 }
 
 bool Engine::acquireNextFrame() {
-  validateVkResult(vkWaitForFences(mGPU.device, 1, &mState.currentFrame->renderFinishedFence,
-                                   VK_TRUE, UINT64_MAX));
+  CBL_TRACE_SCOPE("Engine::acquireNextFrame");
+  mGraphicsTimeline.wait(mState.currentFrame->renderFinishedValue);
 
-  if (VkResult result = vkAcquireNextImageKHR(mGPU.device, mSwapchain.swapchain, UINT64_MAX,
-                                              mState.currentFrame->imageAvailableSemaphore,
-                                              VK_NULL_HANDLE, &mState.imageIndex);
-      result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+  if (mSwapchain.isOffscreen()) {
+    mState.imageIndex = mSwapchain.acquireOffscreenImage();
+    return true;
+  }
+
+  VkResult const result = vkAcquireNextImageKHR(mGPU.device, mSwapchain.swapchain, UINT64_MAX,
+                                                mState.currentFrame->imageAvailableSemaphore,
+                                                VK_NULL_HANDLE, &mState.imageIndex);
+
+  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    mState.swapchainOutdated = true;
     return false;
-  } else {
-    // Image acquired
-    validateVkResult(result);
   }
 
-  validateVkResult(vkResetFences(mGPU.device, 1, &mState.currentFrame->renderFinishedFence));
+  validateVkResult(result);
+
+  // a suboptimal image was still acquired and has to be presented
+  if (result == VK_SUBOPTIMAL_KHR) {
+    mState.swapchainOutdated = true;
+  }
+
   return true;
 }
 
-void Engine::drawScene() {
+bool Engine::drawScene() {
+  CBL_TRACE_SCOPE("Engine::drawScene");
+
   if (mState.currentScene == nullptr) {
-    return;
+    return false;
   }
 
-  if (!mState.shouldRender || !acquireNextFrame()) {
-    if (mSwapchain.isValid(mWindow)) {
-      mSwapchain.handleFrameBufferResize(mWindow);
+  if (mWindow && mWindow->consumeSettledResize(mResizeSettleMs)) {
+    mState.swapchainOutdated = true;
+  }
+
+  if (mWindow && mState.swapchainOutdated) {
+    CBL_TRACE_SCOPE("Swapchain::handleFrameBufferResize");
+    // keeps the outdated swapchain while the window has no drawable area
+    mState.swapchainOutdated = !mSwapchain.handleFrameBufferResize(*mWindow);
+  }
+
+  if (!mState.shouldRender || mState.swapchainOutdated || !acquireNextFrame()) {
+    if (mWindow) {
       ImGui::EndFrame();
     }
-    return;
+    return false;
   }
 
-  ImGui::Render();
+  if (mWindow) {
+    ImGui::Render();
+  }
 
   VkRect2D renderArea;
   renderArea.offset = {0, 0};
   renderArea.extent = mSwapchain.frameBufferImages[0].extent;
 
+  // the camera is drawn between the last two simulation steps, one step behind the simulation
+  RenderSnapshot const &snapshot = mSnapshots.read();
+  float const alpha =
+      std::chrono::duration<float>(std::chrono::steady_clock::now() - snapshot.stepTime).count() /
+      Time::fixedDeltaSeconds();
+  glm::mat4 const cameraView =
+      snapshot.camera.getViewMatrix(mSwapchain.getAspectRatio(), std::clamp(alpha, 0.0f, 1.0f));
+
+  CBL_TRACE_SCOPE("Record frame");
+  VkFramebuffer const framebuffer = mSwapchain.framebuffers[mState.imageIndex];
+
+  // the render pass only executes secondary command buffers, timestamps can't be written inline
   CommandBufferRecorder recorder{mState.currentFrame->commandBuffer};
   recorder.beginOneTime()
-      .setViewPort(renderArea.extent)
-      .setScissor(renderArea)
-      .beginRenderPass(mSwapchain.renderPass, mSwapchain.framebuffers[mState.imageIndex],
-                       renderArea);
+      .beginProfiling(mGpuProfiler)
+      .beginProfileScope(mGpuProfiler, "Frame")
+      .beginProfileScope(mGpuProfiler, "Main pass")
+      .beginRenderPass(mSwapchain.renderPass, framebuffer, renderArea,
+                       VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+  // evicted chunks that came back into view are uploaded before their draws are recorded
+  cullDrawList(snapshot, cameraView);
+  mMemoryManager.beginFrame();
+  mResidency.update(mState.currentScene->meshes, mVisibleMeshes,
+                    snapshot.camera.getPose().position);
+
+  buildRenderQueue(snapshot);
+
+  // the frame's previous submission is complete, its draw data can be overwritten
+  mDrawDataTable.setCamera(mState.currentFrameNumber, cameraView);
+  mRenderQueue.writeDrawData(
+      mDrawDataTable.reserveDraws(mState.currentFrameNumber, mRenderQueue.size()));
+
+  std::vector<VkCommandBuffer> secondaryCommandBuffers = recordChunkDraws(renderArea);
+
+  if (mWindow) {
+    CommandBufferRecorder imguiRecorder{mState.currentFrame->imguiCommandBuffer};
+    imguiRecorder.beginSecondary(mSwapchain.renderPass, framebuffer)
+        .beginProfileScope(mGpuProfiler, "ImGui pass");
+    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), mState.currentFrame->imguiCommandBuffer);
+    imguiRecorder.endProfileScope(mGpuProfiler).end();
+
+    secondaryCommandBuffers.push_back(mState.currentFrame->imguiCommandBuffer);
+  }
+
+  recorder.executeCommands(secondaryCommandBuffers)
+      .endRenderPass()
+      .endProfileScope(mGpuProfiler)
+      .endProfileScope(mGpuProfiler)
+      .end();
+
+  std::vector<Timeline::Wait> waits{};
+  std::vector<VkSemaphore> signalSemaphores{};
+  if (!mSwapchain.isOffscreen()) {
+    waits.push_back({mState.currentFrame->imageAvailableSemaphore,
+                     VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT});
+    signalSemaphores.push_back(mState.currentFrame->renderFinishedSemaphore);
+  }
+  mMemoryManager.getTransferTimeline().dependOnPendingWork(
+      waits, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+  mState.currentFrame->renderFinishedValue =
+      recorder.submit(mGraphicsTimeline, waits, signalSemaphores);
+  mGpuProfiler.endBatch(mState.currentFrame->renderFinishedValue);
+
+  if (mSwapchain.isOffscreen()) {
+    mState.currentFrame =
+        mFrames[++mState.currentFrameNumber %= static_cast<unsigned int>(mFrames.size())].get();
+    return true;
+  }
+
+  VkPresentInfoKHR presentInfo{};
+  presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+  presentInfo.waitSemaphoreCount = 1;
+  presentInfo.pWaitSemaphores = &mState.currentFrame->renderFinishedSemaphore;
+  presentInfo.swapchainCount = 1;
+  presentInfo.pSwapchains = &mSwapchain.swapchain;
+  presentInfo.pImageIndices = &mState.imageIndex;
+
+  CBL_TRACE_SCOPE("vkQueuePresentKHR");
+  if (VkResult const result = vkQueuePresentKHR(mGPU.presentQueue, &presentInfo);
+      result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+    mState.swapchainOutdated = true;
+  } else {
+    validateVkResult(result);
+  }
 
-  for (BaseShader const *shader : mState.currentScene->shaders) {
-    if (!shader) {
+  mState.currentFrame =
+      mFrames[++mState.currentFrameNumber %= static_cast<unsigned int>(mFrames.size())].get();
+
+  return true;
+}
+
+void Engine::cullDrawList(RenderSnapshot const &snapshot, glm::mat4 const &cameraView) {
+  CBL_TRACE_SCOPE("Engine::cullDrawList");
+  std::vector<Mesh> const &meshes = mState.currentScene->meshes;
+  Frustum const frustum{cameraView};
+
+  mVisibleMeshes.clear();
+  for (size_t const meshIndex : snapshot.drawList) {
+    Mesh const &mesh = meshes[meshIndex];
+
+    if (mesh.getRequiredBufferSize() > 0 &&
+        frustum.intersectsSphere(mesh.getWorldCenter(), mesh.radius)) {
+      mVisibleMeshes.push_back(meshIndex);
+    }
+  }
+}
+
+void Engine::buildRenderQueue(RenderSnapshot const &snapshot) {
+  CBL_TRACE_SCOPE("Engine::buildRenderQueue");
+  World const &scene = *mState.currentScene;
+  mRenderQueue.clear();
+
+  // the position of a material's shader in the scene makes up the pipeline part of the sort key
+  std::vector<uint16_t> materialShaderIndices(scene.materials.size());
+  for (size_t i = 0; i < scene.materials.size(); i++) {
+    if (scene.materials[i] == nullptr) {
       continue;
     }
 
-    recorder
-        .bindGraphicsShader(*shader) //
-        .pushCameraView(mState.currentScene->camera.getViewMatrix(mSwapchain.getAspectRatio()),
-                        *shader);
+    auto const shader =
+        std::find(scene.shaders.begin(), scene.shaders.end(), scene.materials[i]->shader);
+    materialShaderIndices[i] = static_cast<uint16_t>(shader - scene.shaders.begin());
+  }
 
-    for (BaseMaterial const *material : mState.currentScene->materials) {
-      if (!material) {
-        continue;
-      }
+  glm::vec3 const cameraPosition = snapshot.camera.getPose().position;
 
-      recorder.bindMaterial(*shader, *material);
+  for (size_t const meshIndex : mVisibleMeshes) {
+    Mesh const &mesh = scene.meshes[meshIndex];
 
-      for (Mesh const &mesh : mState.currentScene->meshes) {
-        recorder
-            .pushModelPosition(mesh.position, *shader) //
-            .drawMesh(mesh);
-      }
+    if (mesh.materialIndex >= scene.materials.size()) {
+      continue;
+    }
+
+    BaseMaterial const *material = scene.materials[mesh.materialIndex];
+    if (material == nullptr || material->shader == nullptr) {
+      continue;
     }
+
+    // opaque geometry goes front to back, so that hidden fragments fail the depth test early
+    uint64_t const sortKey =
+        RenderQueue::makeSortKey(materialShaderIndices[mesh.materialIndex],
+                                 static_cast<uint16_t>(mesh.materialIndex),
+                                 glm::distance(cameraPosition, mesh.getWorldCenter()));
+
+    mRenderQueue.push(DrawItem{sortKey, material->shader, material, &mesh});
   }
 
-  ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), mState.currentFrame->commandBuffer);
+  mRenderQueue.sort();
+}
 
-  recorder.endRenderPass().end();
+std::vector<VkCommandBuffer> Engine::recordChunkDraws(VkRect2D const &renderArea) {
+  Frame &frame = *mState.currentFrame;
+  VkDescriptorSet const drawDataSet = mDrawDataTable.getDescriptorSet(mState.currentFrameNumber);
+  VkFramebuffer const framebuffer = mSwapchain.framebuffers[mState.imageIndex];
+
+  // small queues are not worth waking the workers for
+  size_t const drawCount = mRenderQueue.size();
+  size_t const slotCount =
+      std::clamp((drawCount + mMinDrawsPerRecordingJob - 1) / mMinDrawsPerRecordingJob, size_t{1},
+                 frame.recordingCommandBuffers.size());
+  size_t const drawsPerSlot = (drawCount + slotCount - 1) / slotCount;
+
+  mJobs.parallelFor(slotCount, 1, [&](size_t begin, size_t end) {
+    for (size_t slot = begin; slot < end; slot++) {
+      CBL_TRACE_SCOPE("Record chunk draws");
+
+      // the frame's previous submission is complete, nothing in the pool is in use anymore
+      validateVkResult(vkResetCommandPool(mGPU.device, frame.recordingCommandPools[slot], 0));
+
+      // dynamic state is not inherited from the primary command buffer
+      CommandBufferRecorder recorder{frame.recordingCommandBuffers[slot]};
+      recorder.beginSecondary(mSwapchain.renderPass, framebuffer)
+          .setViewPort(renderArea.extent)
+          .setScissor(renderArea);
+
+      // contiguous ranges of the sorted queue, so that each one keeps the binds it can share
+      size_t const firstDraw = std::min(slot * drawsPerSlot, drawCount);
+      size_t const lastDraw = std::min(firstDraw + drawsPerSlot, drawCount);
+      mRenderQueue.record(recorder, mBindlessTable, drawDataSet, firstDraw, lastDraw);
+
+      recorder.end();
+    }
+  });
 
-  constexpr VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-  VkSubmitInfo submitInfo{};
-  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  submitInfo.pWaitDstStageMask = &waitStage;
-  submitInfo.waitSemaphoreCount = 1;
-  submitInfo.pWaitSemaphores = &mState.currentFrame->imageAvailableSemaphore;
-  submitInfo.signalSemaphoreCount = 1;
-  submitInfo.pSignalSemaphores = &mState.currentFrame->renderFinishedSemaphore;
-  submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &mState.currentFrame->commandBuffer;
+  return std::vector<VkCommandBuffer>{frame.recordingCommandBuffers.begin(),
+                                      frame.recordingCommandBuffers.begin() +
+                                          static_cast<std::ptrdiff_t>(slotCount)};
+}
 
-  validateVkResult(
-      vkQueueSubmit(mGPU.graphicsQueue, 1, &submitInfo, mState.currentFrame->renderFinishedFence));
+void Engine::drawConfigOverlay() {
+  ImGui::Begin("Engine settings");
 
-  VkPresentInfoKHR presentInfo{};
-  presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-  presentInfo.waitSemaphoreCount = 1;
-  presentInfo.pWaitSemaphores = &mState.currentFrame->renderFinishedSemaphore;
-  presentInfo.swapchainCount = 1;
-  presentInfo.pSwapchains = &mSwapchain.swapchain;
-  presentInfo.pImageIndices = &mState.imageIndex;
+  auto framesInFlight = static_cast<int>(mPendingConfig.framesInFlight);
+  if (ImGui::SliderInt("Frames in flight", &framesInFlight, EngineConfig::MinFramesInFlight,
+                       EngineConfig::MaxFramesInFlight)) {
+    mPendingConfig.framesInFlight = static_cast<uint32_t>(framesInFlight);
+  }
+
+  char const *presentModes[] = {
+      toString(EngineConfig::PresentMode::eAuto), toString(EngineConfig::PresentMode::eFifo),
+      toString(EngineConfig::PresentMode::eMailbox),
+      toString(EngineConfig::PresentMode::eImmediate)};
+  auto presentMode = static_cast<int>(mPendingConfig.presentMode);
+  if (ImGui::Combo("Present mode", &presentMode, presentModes, IM_ARRAYSIZE(presentModes))) {
+    mPendingConfig.presentMode = static_cast<EngineConfig::PresentMode>(presentMode);
+  }
+
+  auto swapchainImageCount = static_cast<int>(mPendingConfig.swapchainImageCount);
+  if (ImGui::SliderInt("Swapchain images (0 = auto)", &swapchainImageCount, 0, 8)) {
+    mPendingConfig.swapchainImageCount = static_cast<uint32_t>(swapchainImageCount);
+  }
+
+  ImGui::Text("Current : %u frames in flight, %s, %zu images", mConfig.framesInFlight,
+              toString(mConfig.presentMode), mSwapchain.frameBufferImages.size());
+
+  if (ImGui::Button("Apply")) {
+    mState.configChanged = true;
+  }
+
+  ImGui::End();
+}
+
+void Engine::drawProfilerOverlay() {
+  mGpuProfiler.collect();
+
+  ImGui::Begin("GPU profiler");
+
+  FrameTimeStatistics const frameTimes = Time::getFrameStatistics();
+  ImGui::Text("CPU frame (ms) : avg %.3f, min %.3f, max %.3f, stddev %.3f",
+              frameTimes.averageMs, frameTimes.minMs, frameTimes.maxMs,
+              frameTimes.standardDeviationMs);
+  ImGui::Text("Smoothed : %.1f FPS", 1.0f / std::max(Time::smoothedDeltaSeconds(), 1e-6f));
+
+  ImGui::Separator();
+  ImGui::TextUnformatted("Graphics queue (ms)");
+  mGpuProfiler.drawImGui();
+
+  ImGui::Separator();
+  ImGui::TextUnformatted("Transfer queue (ms)");
+  mMemoryManager.getUploadProfiler().drawImGui();
+
+  if (ImGui::Button("Dump CSV")) {
+    std::ofstream csv{"gpu_profile.csv"};
+    csv << "queue,scope,samples,last_ms,min_ms,average_ms,p99_ms\n";
+    mGpuProfiler.writeCsv(csv, "graphics");
+    mMemoryManager.getUploadProfiler().writeCsv(csv, "transfer");
+  }
+
+#ifdef CBL_ENABLE_TRACING
+  ImGui::SameLine();
+  if (ImGui::Button("Capture CPU trace") && !Trace::isCapturing()) {
+    Trace::captureFrames(mTraceCaptureFrames);
+  }
+#endif
+
+  ImGui::End();
+}
+
+void Engine::drawMemoryOverlay() {
+  ImGui::Begin("Memory");
+  mMemoryTelemetry.drawImGui();
+  ImGui::End();
+}
 
-  validateVkResult(vkQueuePresentKHR(mGPU.presentQueue, &presentInfo));
+bool Engine::applyConfig(EngineConfig const &config) {
+  EngineConfig const previousConfig = mConfig;
+  mConfig = config.clamped();
+  bool applied = true;
+
+  if (mConfig.presentMode != previousConfig.presentMode ||
+      mConfig.swapchainImageCount != previousConfig.swapchainImageCount) {
+    if (mSwapchain.reconfigure(*mWindow, mConfig)) {
+      ImGui_ImplVulkan_SetMinImageCount(
+          static_cast<uint32_t>(mSwapchain.frameBufferImages.size()));
+    } else {
+      // minimised, the swapchain still has the previous settings and is reconfigured once the
+      // window can be drawn to again
+      mConfig.presentMode = previousConfig.presentMode;
+      mConfig.swapchainImageCount = previousConfig.swapchainImageCount;
+      applied = false;
+    }
+  }
+
+  if (mConfig.framesInFlight != previousConfig.framesInFlight) {
+    createFrames();
+  }
 
-  mState.currentFrame = &mFrames[++mState.currentFrameNumber %= mMaxFramesInFlight];
+  return applied;
 }
 
 void Engine::run() {
-  while (mWindow.isOpen()) {
+  if (mConfig.benchmarkFrames > 0 || !mConfig.cameraReplayPath.empty()) {
+    runBenchmark();
+    return;
+  }
+
+  CBL_TRACE_THREAD_NAME("Main");
+  // the camera starts with its controls enabled
+  Input::grabCursor();
+  startSimulation();
+
+  while (mWindow->isOpen()) {
+    // frame boundaries are marked before the scope so the previous frame is complete
+    CBL_TRACE_FRAME();
+    CBL_TRACE_SCOPE("Engine::run frame");
+
+    if (mState.configChanged) {
+      mState.configChanged = !applyConfig(mPendingConfig);
+    }
+
     Time::tick();
-    ImGui_ImplVulkan_NewFrame();
-    mWindow.update();
+    {
+      CBL_TRACE_SCOPE("Window::update");
+      ImGui_ImplVulkan_NewFrame();
+      mWindow->update();
+    }
     ImGui::NewFrame();
     ImGui::ShowMetricsWindow();
+    drawConfigOverlay();
+    drawProfilerOverlay();
+    drawMemoryOverlay();
 
-    mState.currentScene->update();
     drawScene();
+    StartupTimer::reportFirstFrame(std::cout);
+    if (mState.currentScene != nullptr) {
+      mMemoryTelemetry.update(*mState.currentScene, std::cout);
+    }
+    mMemoryManager.collectFinishedUploads();
+    mSwapchain.destroyRetiredResources();
+    mJobs.runMainThreadJobs();
+  }
+
+  stopSimulation();
+
+  if (!mConfig.cameraRecordPath.empty()) {
+    mCameraRecording.save(mConfig.cameraRecordPath);
   }
 }
 
-bool Engine::isRunning() { return mWindow.isOpen(); }
+void Engine::startSimulation() {
+  if (mState.currentScene == nullptr || mSimulationRunning.exchange(true)) {
+    return;
+  }
+
+  // mConfig can change while the simulation runs, it gets its own copy of what it needs
+  bool const recordCamera = !mConfig.cameraRecordPath.empty();
+  mSimulationThread = std::thread{&Engine::simulate, this, recordCamera};
+}
+
+void Engine::stopSimulation() {
+  mSimulationRunning.store(false);
+
+  if (mSimulationThread.joinable()) {
+    mSimulationThread.join();
+  }
+}
+
+void Engine::simulate(bool const &recordCamera) {
+  CBL_TRACE_THREAD_NAME("Simulation");
+
+  auto const stepDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<float>(Time::fixedDeltaSeconds()));
+  auto nextStep = std::chrono::steady_clock::now();
+
+  while (mSimulationRunning.load()) {
+    std::this_thread::sleep_until(nextStep);
+
+    {
+      CBL_TRACE_SCOPE("World::update");
+      Input::consumeEvents();
+      mState.currentScene->update();
+
+      if (recordCamera) {
+        mCameraRecording.record(mState.currentScene->camera, Time::fixedDeltaSeconds());
+      }
+    }
+
+    // steps are stamped with their scheduled time so the renderer sees them evenly spaced
+    publishSnapshot(nextStep);
+    nextStep += stepDuration;
+
+    // missed steps run back to back, unless the simulation fell too far behind to catch up
+    if (auto const now = std::chrono::steady_clock::now(); now - nextStep > mMaxSimulationLag) {
+      nextStep = now;
+    }
+  }
+}
+
+void Engine::publishSnapshot(std::chrono::steady_clock::time_point const &stepTime) {
+  if (mState.currentScene == nullptr) {
+    return;
+  }
+
+  RenderSnapshot &snapshot = mSnapshots.getWriteSlot();
+  snapshot.stepTime = stepTime;
+  snapshot.camera = mState.currentScene->camera;
+
+  snapshot.drawList.clear();
+  for (size_t i = 0; i < mState.currentScene->meshes.size(); i++) {
+    snapshot.drawList.push_back(i);
+  }
+
+  mSnapshots.publish();
+}
+
+void Engine::runBenchmark() {
+  CBL_TRACE_THREAD_NAME("Main");
+
+  std::optional<CameraPath> replay{};
+  if (!mConfig.cameraReplayPath.empty()) {
+    replay = CameraPath::load(mConfig.cameraReplayPath);
+  }
+
+  uint32_t const frameCount =
+      replay ? static_cast<uint32_t>(replay->poses.size()) : mConfig.benchmarkFrames;
+  std::vector<double> cpuFrameTimes{};
+  cpuFrameTimes.reserve(frameCount);
+  // frames that bail out before submitting have a CPU time but no GPU sample
+  std::vector<bool> submittedFrames{};
+  submittedFrames.reserve(frameCount);
+
+  for (uint32_t frame = 0; frame < mBenchmarkWarmupFrames + frameCount && isRunning(); frame++) {
+    if (frame == mBenchmarkWarmupFrames) {
+      // pipeline warm up and the initial uploads are not part of the measurement
+      mGPU.waitIdle();
+      mGpuProfiler.collect();
+      mGpuProfiler.clearSamples();
+      mGpuProfiler.setSampleWindow(frameCount);
+    }
+
+    CBL_TRACE_FRAME();
+    CBL_TRACE_SCOPE("Engine::runBenchmark frame");
+    auto const frameStart = std::chrono::steady_clock::now();
+
+    Time::tick();
+    if (mWindow) {
+      ImGui_ImplVulkan_NewFrame();
+      mWindow->update();
+      Input::consumeEvents();
+      ImGui::NewFrame();
+    }
+
+    // input never reaches the camera, the path alone decides what is on screen
+    if (!replay) {
+      updateBenchmarkCamera(frame, mBenchmarkWarmupFrames + frameCount);
+    } else if (mState.currentScene != nullptr && frameCount > 0) {
+      uint32_t const tick = frame < mBenchmarkWarmupFrames ? 0 : frame - mBenchmarkWarmupFrames;
+      mState.currentScene->camera.setPose(replay->poses[tick]);
+    }
+    publishSnapshot(std::chrono::steady_clock::now());
+    bool const submitted = drawScene();
+    StartupTimer::reportFirstFrame(std::cout);
+    if (mState.currentScene != nullptr) {
+      mMemoryTelemetry.update(*mState.currentScene, std::cout);
+    }
+    mMemoryManager.collectFinishedUploads();
+    // returns finished query batches to the pool, no overlay does it during benchmarks
+    mGpuProfiler.collect();
+    mSwapchain.destroyRetiredResources();
+    mJobs.runMainThreadJobs();
+
+    if (frame >= mBenchmarkWarmupFrames) {
+      cpuFrameTimes.push_back(std::chrono::duration<double, std::milli>(
+                                  std::chrono::steady_clock::now() - frameStart)
+                                  .count());
+      submittedFrames.push_back(submitted);
+    }
+  }
+
+  mGPU.waitIdle();
+  mGpuProfiler.collect();
+
+  std::vector<double> const gpuFrameTimes = mGpuProfiler.getSamples("Frame");
+  writeBenchmarkReport(cpuFrameTimes, gpuFrameTimes);
+
+  if (!mConfig.frameTimesOutput.empty()) {
+    writeFrameTimes(cpuFrameTimes, gpuFrameTimes, submittedFrames);
+  }
+}
+
+void Engine::updateBenchmarkCamera(uint32_t const &frame, uint32_t const &frameCount) {
+  if (mState.currentScene == nullptr || mState.currentScene->meshes.empty()) {
+    return;
+  }
+
+  glm::vec2 minimum{std::numeric_limits<float>::max()};
+  glm::vec2 maximum{std::numeric_limits<float>::lowest()};
+  for (Mesh const &mesh : mState.currentScene->meshes) {
+    glm::vec2 const meshPosition{mesh.position[3].x, mesh.position[3].z};
+    minimum = glm::min(minimum, meshPosition);
+    maximum = glm::max(maximum, meshPosition);
+  }
+
+  // one full orbit around the scene, the same for every run
+  glm::vec2 const center = (minimum + maximum) * 0.5f;
+  float const radius = std::max(glm::length(maximum - minimum) * 0.5f, 16.0f);
+  float const angle = glm::two_pi<float>() * static_cast<float>(frame) /
+                      static_cast<float>(std::max(frameCount, 1u));
+
+  glm::vec3 const position{center.x + radius * std::cos(angle), 32.0f,
+                           center.y + radius * std::sin(angle)};
+  mState.currentScene->camera.setView(position, glm::vec3{center.x, 8.0f, center.y});
+}
+
+void Engine::writeBenchmarkReport(std::vector<double> const &cpuFrameTimes,
+                                  std::vector<double> const &gpuFrameTimes) const {
+  auto const writeStatistics = [](std::ostream &stream, std::vector<double> samples) {
+    if (samples.empty()) {
+      stream << "null";
+      return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto const percentile = [&samples](double const &p) {
+      auto const rank = static_cast<size_t>(std::ceil(p / 100.0 * samples.size()));
+      return samples[std::clamp(rank, size_t{1}, samples.size()) - 1];
+    };
+
+    stream << "{\"samples\": " << samples.size() << ", \"min\": " << samples.front()
+           << ", \"mean\": "
+           << std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size()
+           << ", \"p50\": " << percentile(50) << ", \"p90\": " << percentile(90)
+           << ", \"p95\": " << percentile(95) << ", \"p99\": " << percentile(99)
+           << ", \"max\": " << samples.back() << "}";
+  };
+
+  VkPhysicalDeviceProperties deviceProperties{};
+  vkGetPhysicalDeviceProperties(mGPU.physicalDevice, &deviceProperties);
+
+  std::ofstream report{mConfig.benchmarkOutput};
+  report << "{\n";
+  report << "  \"device\": \"" << deviceProperties.deviceName << "\",\n";
+  report << "  \"headless\": " << (mWindow ? "false" : "true") << ",\n";
+  report << "  \"width\": " << mSwapchain.frameBufferImages[0].extent.width << ",\n";
+  report << "  \"height\": " << mSwapchain.frameBufferImages[0].extent.height << ",\n";
+  report << "  \"framesInFlight\": " << mConfig.framesInFlight << ",\n";
+  report << "  \"camera\": \""
+         << (mConfig.cameraReplayPath.empty() ? "orbit" : mConfig.cameraReplayPath) << "\",\n";
+  report << "  \"cpuFrameMs\": ";
+  writeStatistics(report, cpuFrameTimes);
+  report << ",\n  \"gpuFrameMs\": ";
+  writeStatistics(report, gpuFrameTimes);
+  report << "\n}\n";
+}
+
+void Engine::writeFrameTimes(std::vector<double> const &cpuFrameTimes,
+                             std::vector<double> const &gpuFrameTimes,
+                             std::vector<bool> const &submittedFrames) const {
+  // The profiler keeps one sample per submitted frame, in submission order. When the counts do
+  // not match, the samples cannot be matched to their frames and the GPU column is left empty
+  // rather than shifted. It is also empty when timestamps are not supported
+  auto const submittedCount =
+      static_cast<size_t>(std::count(submittedFrames.begin(), submittedFrames.end(), true));
+  bool const matched = gpuFrameTimes.size() == submittedCount;
+  if (!matched && !gpuFrameTimes.empty()) {
+    std::cerr << "Got " << gpuFrameTimes.size() << " GPU frame times for " << submittedCount
+              << " submitted frames, " << mConfig.frameTimesOutput << " has no GPU column\n";
+  }
+
+  std::ofstream output{mConfig.frameTimesOutput};
+  output << "frame,cpu_ms,gpu_ms\n";
+
+  size_t gpuSample = 0;
+  for (size_t frame = 0; frame < cpuFrameTimes.size(); frame++) {
+    output << frame << ',' << cpuFrameTimes[frame] << ',';
+    if (submittedFrames[frame]) {
+      if (matched) {
+        output << gpuFrameTimes[gpuSample];
+      }
+      gpuSample++;
+    }
+    output << '\n';
+  }
+}
+
+bool Engine::isRunning() { return !mWindow || mWindow->isOpen(); }
 
 void Engine::loadWorld(World &scene) {
   if (mState.currentScene != nullptr) {
@@ -189,15 +765,86 @@ void Engine::loadWorld(World &scene) {
 
   mState.currentScene = &scene;
 
-  for (Mesh &mesh : mState.currentScene->meshes) {
-    if (!mesh.buffer.isValid) {
-      mMemoryManager.generateMeshBuffer(mesh);
-    }
+  // building the pipeline and loading the textures only need the device, the workers do it while
+  // this thread uploads the meshes. Jobs must not throw, their errors are rethrown here
+  jobs::Counter counter{};
+
+  BaseShader *shader = nullptr;
+  std::exception_ptr shaderError{};
+  mJobs.schedule(
+      [this, &shader, &shaderError]() {
+        StartupTimer::Phase phase{"Pipeline creation"};
+        try {
+          shader = new ChunkShader{mGPU, mSwapchain.renderPass, mPipelineCache.pipelineCache,
+                                   mBindlessTable, mDrawDataTable};
+        } catch (...) {
+          shaderError = std::current_exception();
+        }
+      },
+      &counter);
+
+  // only decodes the images when the cooked texture is missing or out of date. When it cannot be
+  // cooked either, the decoded images are uploaded as is and their mips are generated on the GPU
+  mem::CookedTexture cookedTexture{};
+  std::vector<mem::TextureImage> textureImages{};
+  std::exception_ptr textureError{};
+  mJobs.schedule(
+      [this, &cookedTexture, &textureImages, &textureError]() {
+        StartupTimer::Phase phase{"Texture load"};
+        try {
+          cookedTexture = mem::TextureCooker::load(ChunkMaterial::TexturePaths,
+                                                   ChunkMaterial::CookedTexturePath, mJobs);
+          return;
+        } catch (std::exception const &exception) {
+          std::cerr << "Failed to load the cooked texture : " << exception.what() << '\n';
+        }
+
+        try {
+          for (std::filesystem::path const &path : ChunkMaterial::TexturePaths) {
+            textureImages.push_back(mem::MemoryManager::decodeTextureImage(path));
+          }
+        } catch (...) {
+          textureError = std::current_exception();
+        }
+      },
+      &counter);
+
+  // the jobs reference these locals, they have to finish before anything is rethrown
+  std::exception_ptr meshError{};
+  try {
+    StartupTimer::Phase phase{"Mesh upload"};
+    // chunks that do not fit in the budget are uploaded once they are visible
+    mResidency.makeResident(mState.currentScene->meshes,
+                            mState.currentScene->camera.getPose().position);
+  } catch (...) {
+    meshError = std::current_exception();
+  }
+
+  mJobs.wait(counter);
+
+  // owned by the scene from here, so unloadWorld cleans it up even if something failed
+  if (shader != nullptr) {
+    mState.currentScene->shaders.push_back(shader);
+  }
+  if (meshError) {
+    std::rethrow_exception(meshError);
+  }
+  if (shaderError) {
+    std::rethrow_exception(shaderError);
+  }
+  if (textureError) {
+    std::rethrow_exception(textureError);
+  }
+
+  {
+    StartupTimer::Phase phase{"Material creation"};
+    mState.currentScene->materials.push_back(
+        textureImages.empty()
+            ? new ChunkMaterial{mGPU, mMemoryManager, mBindlessTable, shader, cookedTexture}
+            : new ChunkMaterial{mGPU, mMemoryManager, mBindlessTable, shader, textureImages});
   }
 
-  mState.currentScene->shaders.push_back(new ChunkShader{mGPU, mSwapchain.renderPass});
-  mState.currentScene->materials.push_back(
-      new ChunkMaterial{mGPU, mMemoryManager, mState.currentScene->shaders[0]});
+  publishSnapshot(std::chrono::steady_clock::now());
 }
 
 void Engine::unloadWorld() {
@@ -205,13 +852,11 @@ void Engine::unloadWorld() {
     return;
   }
 
+  stopSimulation();
+
   mGPU.waitIdle();
 
-  for (Mesh &mesh : mState.currentScene->meshes) {
-    if (mesh.buffer.isValid) {
-      mesh.buffer.memoryManager->destroyBuffer(mesh.buffer);
-    }
-  }
+  mResidency.releaseAll(mState.currentScene->meshes);
 
   for (BaseMaterial *material : mState.currentScene->materials) {
     delete material;
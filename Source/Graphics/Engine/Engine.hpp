@@ -1,17 +1,34 @@
 ﻿#pragma once
 
-#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 
+#include "Core/Jobs/Scheduler.hpp"
+#include "Core/Threading/TripleBuffer.hpp"
+#include "Core/World/RenderSnapshot.hpp"
 #include "Core/World/World.hpp"
+#include "Graphics/Bindless/BindlessTable.hpp"
+#include "Graphics/DrawData/DrawDataTable.hpp"
 #include "Graphics/Camera/Camera.hpp"
+#include "Graphics/Camera/CameraPath.hpp"
+#include "Graphics/Engine/EngineConfig.hpp"
 #include "Graphics/Frame/Frame.hpp"
 #include "Graphics/GPU/GPU.hpp"
 #include "Graphics/Memory/Buffer/Buffer.hpp"
+#include "Graphics/Memory/Residency/ResidencyManager.hpp"
 #include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
 #include "Graphics/Mesh/Mesh.hpp"
+#include "Graphics/PipelineCache/PipelineCache.hpp"
+#include "Graphics/Profiler/GpuProfiler.hpp"
+#include "Graphics/RenderQueue/RenderQueue.hpp"
 #include "Graphics/Swapchain/Swapchain.hpp"
+#include "Graphics/Telemetry/MemoryTelemetry.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
 #include "Graphics/Window/Window.hpp"
 
 namespace cbl::gfx {
@@ -24,26 +41,84 @@ private:
     unsigned int currentFrameNumber = 0;
     unsigned int imageIndex = 0;
     bool shouldRender = true;
+    bool configChanged = false;
+    bool swapchainOutdated = false;
   } mState;
 
-  Window mWindow;
+  EngineConfig mConfig;
+  EngineConfig mPendingConfig;
+
+  jobs::Scheduler &mJobs;
+
+  std::unique_ptr<Window> mWindow; // null in headless mode
 
   GPU mGPU;
+  Timeline mGraphicsTimeline;
   mem::MemoryManager mMemoryManager;
+  BindlessTable mBindlessTable;
+  DrawDataTable mDrawDataTable;
+  mem::ResidencyManager mResidency;
+  MemoryTelemetry mMemoryTelemetry;
+  GpuProfiler mGpuProfiler;
+  PipelineCache mPipelineCache;
 
   Swapchain mSwapchain;
+  static constexpr uint32_t mResizeSettleMs = 50;
+  static constexpr uint32_t mTraceCaptureFrames = 120;
 
-  static constexpr unsigned int mMaxFramesInFlight = 2;
-  std::array<Frame, mMaxFramesInFlight> mFrames;
+  std::vector<std::unique_ptr<Frame>> mFrames;
+  void createFrames();
 
   VkDescriptorPool imguiPool;
   void initImgui();
 
+  void drawConfigOverlay();
+  void drawProfilerOverlay();
+  void drawMemoryOverlay();
+  // false when part of config has to be applied again later
+  [[nodiscard]] bool applyConfig(EngineConfig const &config);
+
   bool acquireNextFrame();
-  void drawScene();
+  // true when a frame was submitted to the GPU
+  bool drawScene();
+
+  // the snapshot's draw list without the meshes outside the view, rebuilt every frame
+  std::vector<size_t> mVisibleMeshes{};
+  void cullDrawList(RenderSnapshot const &snapshot, glm::mat4 const &cameraView);
+
+  RenderQueue mRenderQueue{};
+  void buildRenderQueue(RenderSnapshot const &snapshot);
+
+  static constexpr size_t mMinDrawsPerRecordingJob = 128;
+  // records the render queue into as many secondary command buffers as it is worth, in parallel
+  [[nodiscard]] std::vector<VkCommandBuffer> recordChunkDraws(VkRect2D const &renderArea);
+
+  // World::update runs on its own thread at a fixed rate, and hands its results to the render
+  // loop through snapshots
+  TripleBuffer<RenderSnapshot> mSnapshots{};
+  std::thread mSimulationThread{};
+  std::atomic<bool> mSimulationRunning{false};
+  static constexpr std::chrono::milliseconds mMaxSimulationLag{250};
+
+  void startSimulation();
+  void stopSimulation();
+  void simulate(bool const &recordCamera);
+  void publishSnapshot(std::chrono::steady_clock::time_point const &stepTime);
+
+  CameraPath mCameraRecording{}; // only touched by the simulation thread while it runs
+
+  static constexpr uint32_t mBenchmarkWarmupFrames = 30;
+  void updateBenchmarkCamera(uint32_t const &frame, uint32_t const &frameCount);
+  void writeBenchmarkReport(std::vector<double> const &cpuFrameTimes,
+                            std::vector<double> const &gpuFrameTimes) const;
+  // submittedFrames tells, for every CPU frame time, whether that frame reached the GPU
+  void writeFrameTimes(std::vector<double> const &cpuFrameTimes,
+                       std::vector<double> const &gpuFrameTimes,
+                       std::vector<bool> const &submittedFrames) const;
 
 public:
-  Engine();
+  // jobs scheduled on the main thread run once per frame
+  explicit Engine(jobs::Scheduler &jobs, EngineConfig const &config = {});
   Engine(Engine const &) = delete;
   ~Engine();
 
@@ -51,6 +126,10 @@ public:
   void operator=(Engine) = delete;
 
   void run();
+  // Renders config.benchmarkFrames frames along a fixed camera orbit, or one frame per pose of
+  // config.cameraReplayPath, then writes CPU and GPU frame time percentiles to
+  // config.benchmarkOutput
+  void runBenchmark();
 
   [[nodiscard]] bool isRunning();
 
@@ -0,0 +1,126 @@
+#include "EngineConfig.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace cbl::gfx {
+
+namespace {
+bool readOption(std::string const &argument, std::string const &name, std::string &value) {
+  std::string const prefix = "--" + name + "=";
+
+  if (argument.rfind(prefix, 0) != 0) {
+    return false;
+  }
+
+  value = argument.substr(prefix.size());
+  return true;
+}
+
+uint32_t parseUnsigned(std::string const &value, std::string const &name) {
+  try {
+    return static_cast<uint32_t>(std::stoul(value));
+  } catch (std::exception const &) {
+    throw std::invalid_argument("Invalid value for --" + name + " : " + value);
+  }
+}
+
+std::pair<uint32_t, uint32_t> parseResolution(std::string const &value) {
+  size_t const separator = value.find('x');
+
+  if (separator == std::string::npos) {
+    throw std::invalid_argument("Invalid value for --resolution : " + value);
+  }
+
+  return {parseUnsigned(value.substr(0, separator), "resolution"),
+          parseUnsigned(value.substr(separator + 1), "resolution")};
+}
+
+EngineConfig::PresentMode parsePresentMode(std::string const &value) {
+  for (EngineConfig::PresentMode presentMode :
+       {EngineConfig::PresentMode::eAuto, EngineConfig::PresentMode::eFifo,
+        EngineConfig::PresentMode::eMailbox, EngineConfig::PresentMode::eImmediate}) {
+    if (value == toString(presentMode)) {
+      return presentMode;
+    }
+  }
+
+  throw std::invalid_argument("Invalid value for --present-mode : " + value);
+}
+} // namespace
+
+EngineConfig EngineConfig::fromArguments(int const &argc, char const *const *argv) {
+  EngineConfig config{};
+
+  for (int i = 1; i < argc; i++) {
+    std::string const argument{argv[i]};
+    std::string value;
+
+    if (readOption(argument, "frames-in-flight", value)) {
+      config.framesInFlight = parseUnsigned(value, "frames-in-flight");
+    } else if (readOption(argument, "present-mode", value)) {
+      config.presentMode = parsePresentMode(value);
+    } else if (readOption(argument, "swapchain-images", value)) {
+      config.swapchainImageCount = parseUnsigned(value, "swapchain-images");
+    } else if (readOption(argument, "memory-budget", value)) {
+      config.memoryBudgetPercent = parseUnsigned(value, "memory-budget");
+    } else if (readOption(argument, "memory-log", value)) {
+      config.memoryLogSeconds = parseUnsigned(value, "memory-log");
+    } else if (argument == "--headless") {
+      config.headless = true;
+    } else if (readOption(argument, "resolution", value)) {
+      std::tie(config.width, config.height) = parseResolution(value);
+    } else if (readOption(argument, "benchmark", value)) {
+      config.benchmarkFrames = parseUnsigned(value, "benchmark");
+    } else if (readOption(argument, "benchmark-output", value)) {
+      config.benchmarkOutput = value;
+    } else if (readOption(argument, "frame-times-output", value)) {
+      config.frameTimesOutput = value;
+    } else if (readOption(argument, "record-camera", value)) {
+      config.cameraRecordPath = value;
+    } else if (readOption(argument, "replay-camera", value)) {
+      config.cameraReplayPath = value;
+    } else if (readOption(argument, "world", value)) {
+      config.worldDirectory = value;
+    } else if (argument == "--no-mesh-cache") {
+      config.meshCache = false;
+    }
+  }
+
+  return config.clamped();
+}
+
+EngineConfig EngineConfig::clamped() const {
+  EngineConfig config{*this};
+  config.framesInFlight = std::clamp(framesInFlight, MinFramesInFlight, MaxFramesInFlight);
+  config.memoryBudgetPercent =
+      std::clamp(memoryBudgetPercent, MinMemoryBudgetPercent, MaxMemoryBudgetPercent);
+  config.width = std::max(width, 1u);
+  config.height = std::max(height, 1u);
+
+  // nothing could ever stop a headless run that is not a benchmark
+  if (headless && benchmarkFrames == 0) {
+    config.benchmarkFrames = DefaultBenchmarkFrames;
+  }
+
+  return config;
+}
+
+char const *toString(EngineConfig::PresentMode const &presentMode) {
+  switch (presentMode) {
+  case EngineConfig::PresentMode::eAuto:
+    return "auto";
+  case EngineConfig::PresentMode::eFifo:
+    return "fifo";
+  case EngineConfig::PresentMode::eMailbox:
+    return "mailbox";
+  case EngineConfig::PresentMode::eImmediate:
+    return "immediate";
+  }
+
+  return "unknown";
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace cbl::gfx {
+struct EngineConfig {
+  enum class PresentMode { eAuto, eFifo, eMailbox, eImmediate };
+
+  static constexpr uint32_t MinFramesInFlight = 1;
+  static constexpr uint32_t MaxFramesInFlight = 4;
+  static constexpr uint32_t DefaultBenchmarkFrames = 600;
+  static constexpr uint32_t MinMemoryBudgetPercent = 10;
+  static constexpr uint32_t MaxMemoryBudgetPercent = 100;
+
+  uint32_t framesInFlight = 2;
+  PresentMode presentMode = PresentMode::eAuto;
+  uint32_t swapchainImageCount = 0; // 0 lets the swapchain pick its own image count
+  // part of the device memory budget chunk meshes can fill before far away ones are evicted
+  uint32_t memoryBudgetPercent = 80;
+  uint32_t memoryLogSeconds = 0; // 0 never writes the memory telemetry line
+
+  // headless runs render to offscreen images, without a window or a surface
+  bool headless = false;
+  uint32_t width = 1280;
+  uint32_t height = 720;
+  uint32_t benchmarkFrames = 0; // 0 runs interactively
+  std::string benchmarkOutput = "benchmark.json";
+  std::string frameTimesOutput{}; // per frame CPU and GPU times of a benchmark, as CSV
+
+  std::string cameraRecordPath{}; // interactive runs save the camera path there on exit
+  std::string cameraReplayPath{}; // benchmarks follow this path instead of orbiting the scene
+
+  // saved chunks and seed, benchmarks never use it. Empty keeps the world in memory only
+  std::string worldDirectory = "world";
+  bool meshCache = true; // saves chunk meshes in the world directory, to skip meshing them again
+
+  // Parses --frames-in-flight=<1-4>, --present-mode=<auto|fifo|mailbox|immediate>,
+  // --swapchain-images=<n>, --memory-budget=<10-100 percent>, --memory-log=<seconds>, --headless,
+  // --resolution=<w>x<h>, --benchmark=<frames>, --benchmark-output=<path>,
+  // --frame-times-output=<path>, --record-camera=<path>, --replay-camera=<path>,
+  // --world=<directory> and --no-mesh-cache. Arguments that are not engine options are ignored.
+  [[nodiscard]] static EngineConfig fromArguments(int const &argc, char const *const *argv);
+
+  [[nodiscard]] EngineConfig clamped() const;
+};
+
+[[nodiscard]] char const *toString(EngineConfig::PresentMode const &presentMode);
+} // namespace cbl::gfx
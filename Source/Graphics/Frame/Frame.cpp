@@ -3,7 +3,7 @@
 #include "Graphics/Utils/VulkanHelpers.hpp"
 
 namespace cbl::gfx {
-Frame::Frame(GPU const &gpu) : mGPU{gpu} {
+Frame::Frame(GPU const &gpu, uint32_t const &recordingSlotCount) : mGPU{gpu} {
   // command pool
   VkCommandPoolCreateInfo commandPoolCreateInfo{};
   commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -23,6 +23,27 @@ Frame::Frame(GPU const &gpu) : mGPU{gpu} {
   validateVkResult(
       vkAllocateCommandBuffers(gpu.device, &commandBufferAllocateInfo, &commandBuffer));
 
+  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+  validateVkResult(
+      vkAllocateCommandBuffers(gpu.device, &commandBufferAllocateInfo, &imguiCommandBuffer));
+
+  // recording pools are reset as a whole, by the thread recording into them
+  VkCommandPoolCreateInfo recordingPoolCreateInfo{};
+  recordingPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  recordingPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+  recordingPoolCreateInfo.queueFamilyIndex = gpu.queueFamilyIndices.graphics;
+
+  recordingCommandPools.resize(recordingSlotCount);
+  recordingCommandBuffers.resize(recordingSlotCount);
+  for (uint32_t i = 0; i < recordingSlotCount; i++) {
+    validateVkResult(vkCreateCommandPool(gpu.device, &recordingPoolCreateInfo, nullptr,
+                                         &recordingCommandPools[i]));
+
+    commandBufferAllocateInfo.commandPool = recordingCommandPools[i];
+    validateVkResult(vkAllocateCommandBuffers(gpu.device, &commandBufferAllocateInfo,
+                                              &recordingCommandBuffers[i]));
+  }
+
   // sync objects
   VkSemaphoreCreateInfo semaphoreCreateInfo{};
   semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -31,19 +52,16 @@ Frame::Frame(GPU const &gpu) : mGPU{gpu} {
       vkCreateSemaphore(gpu.device, &semaphoreCreateInfo, nullptr, &imageAvailableSemaphore));
   validateVkResult(
       vkCreateSemaphore(gpu.device, &semaphoreCreateInfo, nullptr, &renderFinishedSemaphore));
-
-  VkFenceCreateInfo fenceCreateInfo{};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-  validateVkResult(vkCreateFence(gpu.device, &fenceCreateInfo, nullptr, &renderFinishedFence));
 }
 
 Frame::~Frame() {
   mGPU.waitIdle();
   vkDestroySemaphore(mGPU.device, imageAvailableSemaphore, nullptr);
   vkDestroySemaphore(mGPU.device, renderFinishedSemaphore, nullptr);
-  vkDestroyFence(mGPU.device, renderFinishedFence, nullptr);
   vkDestroyCommandPool(mGPU.device, commandPool, nullptr);
+
+  for (VkCommandPool const &recordingCommandPool : recordingCommandPools) {
+    vkDestroyCommandPool(mGPU.device, recordingCommandPool, nullptr);
+  }
 }
 } // namespace flex
\ No newline at end of file
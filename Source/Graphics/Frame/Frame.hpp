@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "vulkan/vulkan.h"
 
 #include "Graphics/GPU/GPU.hpp"
@@ -11,13 +13,19 @@ struct Frame {
 public:
   VkSemaphore imageAvailableSemaphore{};
   VkSemaphore renderFinishedSemaphore{};
-  VkFence renderFinishedFence{};
+  uint64_t renderFinishedValue{0}; // graphics timeline value signaled by the last submission
 
   VkCommandPool commandPool{};
   VkCommandBuffer commandBuffer{};
+  VkCommandBuffer imguiCommandBuffer{}; // secondary, recorded on the main thread
+
+  // secondary command buffers recorded in parallel, each with its own pool since a pool can only
+  // be used by one thread at a time
+  std::vector<VkCommandPool> recordingCommandPools{};
+  std::vector<VkCommandBuffer> recordingCommandBuffers{};
 
   Frame() = delete;
-  explicit Frame(GPU const &gpu);
+  Frame(GPU const &gpu, uint32_t const &recordingSlotCount);
   ~Frame();
 };
 } // namespace flex
\ No newline at end of file
@@ -38,10 +38,13 @@ QueueFamilyIndices::QueueFamilyIndices(VkPhysicalDevice const &physicalDevice,
       transfer = i;
     }
 
-    VkBool32 surfaceSupported;
-    vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &surfaceSupported);
-    if (surfaceSupported == VK_TRUE && !presentFound) {
-      present = i;
+    // headless devices have no surface to present to
+    if (surface != VK_NULL_HANDLE) {
+      VkBool32 surfaceSupported;
+      vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &surfaceSupported);
+      if (surfaceSupported == VK_TRUE && !presentFound) {
+        present = i;
+      }
     }
 
     i++;
@@ -51,15 +54,24 @@ QueueFamilyIndices::QueueFamilyIndices(VkPhysicalDevice const &physicalDevice,
     // graphics queues always support transfer
     transfer = graphics;
   }
+
+  if (surface == VK_NULL_HANDLE) {
+    present = graphics;
+  }
 }
 
 std::set<uint32_t> QueueFamilyIndices::getUniqueIndices() const {
   return std::set<uint32_t>{graphics, transfer, present};
 }
 
-GPU::GPU(Window const &window) {
+GPU::GPU(Window const *window) {
   createInstance(window);
-  renderSurface = window.getDrawableVulkanSurface(instance);
+
+  if (window != nullptr) {
+    renderSurface = window->getDrawableVulkanSurface(instance);
+    mRequiredDeviceExtensionsNames.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+  }
+
   selectPhysicalDevice();
   queueFamilyIndices = QueueFamilyIndices{physicalDevice, renderSurface};
   createDevice();
@@ -68,20 +80,37 @@ GPU::GPU(Window const &window) {
 
 GPU::~GPU() {
   vkDestroyDevice(device, nullptr);
-  vkDestroySurfaceKHR(instance, renderSurface, nullptr);
+  if (renderSurface != VK_NULL_HANDLE) {
+    vkDestroySurfaceKHR(instance, renderSurface, nullptr);
+  }
   vkDestroyInstance(instance, nullptr);
 }
 
-void GPU::createInstance(Window const &renderWindow) {
+void GPU::createInstance(Window const *renderWindow) {
   VkApplicationInfo appInfo{};
   appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
   appInfo.pApplicationName = "Cobblestone";
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "Cobblestone";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
 
-  std::vector<char const *> enabledExtensions = renderWindow.getRequiredVulkanExtensions();
+  // vkEnumerateInstanceVersion does not exist on Vulkan 1.0 loaders
+  auto const enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+      vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+  if (enumerateInstanceVersion != nullptr &&
+      enumerateInstanceVersion(&mInstanceApiVersion) == VK_SUCCESS &&
+      mInstanceApiVersion >= VK_API_VERSION_1_2) {
+    mInstanceApiVersion = VK_API_VERSION_1_2;
+  } else {
+    mInstanceApiVersion = VK_API_VERSION_1_0;
+  }
+
+  appInfo.apiVersion = mInstanceApiVersion;
+
+  std::vector<char const *> enabledExtensions{};
+  if (renderWindow != nullptr) {
+    enabledExtensions = renderWindow->getRequiredVulkanExtensions();
+  }
   std::vector<char const *> enabledLayers{};
 
 #ifndef NDEBUG
@@ -139,9 +168,52 @@ void GPU::createDevice() {
 
   VkPhysicalDeviceFeatures enabledDeviceFeatures{};
   enabledDeviceFeatures.samplerAnisotropy = VK_TRUE;
+  enabledDeviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+  VkPhysicalDeviceVulkan12Features enabledVulkan12Features{};
+  enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+  VkPhysicalDeviceProperties physicalDeviceProperties{};
+  vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+
+  bool const vulkan12Available = mInstanceApiVersion >= VK_API_VERSION_1_2 &&
+                                 physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2;
+
+  if (vulkan12Available) {
+    VkPhysicalDeviceVulkan12Features availableVulkan12Features{};
+    availableVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 availableFeatures{};
+    availableFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    availableFeatures.pNext = &availableVulkan12Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &availableFeatures);
+
+    supportsTimelineSemaphores = availableVulkan12Features.timelineSemaphore == VK_TRUE;
+    enabledVulkan12Features.timelineSemaphore = availableVulkan12Features.timelineSemaphore;
+
+    supportsHostQueryReset = availableVulkan12Features.hostQueryReset == VK_TRUE;
+    enabledVulkan12Features.hostQueryReset = availableVulkan12Features.hostQueryReset;
+
+    supportsDescriptorIndexing =
+        availableVulkan12Features.descriptorBindingPartiallyBound == VK_TRUE &&
+        availableVulkan12Features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE;
+    enabledVulkan12Features.descriptorBindingPartiallyBound = supportsDescriptorIndexing;
+    enabledVulkan12Features.descriptorBindingSampledImageUpdateAfterBind =
+        supportsDescriptorIndexing;
+
+    // needs vkGetPhysicalDeviceMemoryProperties2, which is core since Vulkan 1.1
+    supportsMemoryBudget =
+        physicalDeviceSupportsExtensions(physicalDevice, {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME});
+    if (supportsMemoryBudget) {
+      mRequiredDeviceExtensionsNames.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+  }
 
   VkDeviceCreateInfo deviceCreateInfo{};
   deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  if (vulkan12Available) {
+    deviceCreateInfo.pNext = &enabledVulkan12Features;
+  }
   deviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   deviceCreateInfo.pQueueCreateInfos = queueCreateInfos.data();
   deviceCreateInfo.enabledExtensionCount =
@@ -175,10 +247,19 @@ unsigned int GPU::ratePhysicalDevice(VkPhysicalDevice const &physicalDevice,
     return 0u;
   }
 
+  // materials pick their texture from an array, see BindlessTable
+  if (!physicalDeviceFeatures.shaderSampledImageArrayDynamicIndexing) {
+    return 0u;
+  }
+
   if (!physicalDeviceSupportsExtensions(physicalDevice, requiredExtensions)) {
     return 0u;
   }
 
+  if (vulkanSurface == VK_NULL_HANDLE) {
+    return score;
+  }
+
   if (SwapchainSupportDetails const swapchainSupportDetails{physicalDevice, vulkanSurface};
       !swapchainSupportDetails.isUsable()) {
     return 0u;
@@ -220,4 +301,6 @@ bool GPU::isDedicated() const {
   return deviceProperties.deviceType & VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
 }
 
+bool GPU::isHeadless() const { return renderSurface == VK_NULL_HANDLE; }
+
 } // namespace cbl::gfx
\ No newline at end of file
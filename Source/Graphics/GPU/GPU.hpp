@@ -23,11 +23,11 @@ struct QueueFamilyIndices {
 
 struct GPU {
 private:
-  std::vector<const char *> mRequiredDeviceExtensionsNames{
-      VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-  };
+  std::vector<const char *> mRequiredDeviceExtensionsNames{};
 
-  void createInstance(Window const &renderWindow);
+  uint32_t mInstanceApiVersion{VK_API_VERSION_1_0};
+
+  void createInstance(Window const *renderWindow);
   void selectPhysicalDevice();
   void createDevice();
   void retrieveQueues();
@@ -41,7 +41,8 @@ private:
 
 public:
   GPU() = default;
-  explicit GPU(Window const &window);
+  // a null window creates a headless device, without a surface or the swapchain extension
+  explicit GPU(Window const *window);
   ~GPU();
 
   VkInstance instance{};
@@ -54,8 +55,17 @@ public:
   VkQueue transferQueue{};
   VkQueue presentQueue{};
 
+  bool supportsTimelineSemaphores{false};
+  // descriptors can be left unwritten and updated while in use, see BindlessTable
+  bool supportsDescriptorIndexing{false};
+  // the driver reports how much memory the process can use, see MemoryManager::getBudget
+  bool supportsMemoryBudget{false};
+  // query pools can be reset from the CPU, including the ones used on transfer only queues
+  bool supportsHostQueryReset{false};
+
   void waitIdle() const;
 
   [[nodiscard]] bool isDedicated() const;
+  [[nodiscard]] bool isHeadless() const;
 };
 } // namespace cbl::gfx
\ No newline at end of file
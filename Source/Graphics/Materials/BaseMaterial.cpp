@@ -3,7 +3,7 @@
 namespace cbl::gfx {
 
 BaseMaterial::BaseMaterial(GPU const &gpu, mem::MemoryManager &memoryManager,
-                           BaseShader const *shader)
-    : mMemoryManager{memoryManager} {}
+                           BindlessTable &bindlessTable, BaseShader const *shader)
+    : mMemoryManager{memoryManager}, mBindlessTable{bindlessTable}, shader{shader} {}
 
 } // namespace cbl::gfx
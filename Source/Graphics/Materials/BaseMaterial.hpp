@@ -4,6 +4,7 @@
 
 #include <vulkan/vulkan.h>
 
+#include "Graphics/Bindless/BindlessTable.hpp"
 #include "Graphics/GPU/GPU.hpp"
 #include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
 #include "Graphics/Memory/Texture/Texture.hpp"
@@ -13,13 +14,16 @@ namespace cbl::gfx {
 struct BaseMaterial {
 protected:
   mem::MemoryManager &mMemoryManager;
+  BindlessTable &mBindlessTable;
 
 public:
-  std::vector<VkDescriptorSet> descriptorSets;
+  BaseShader const *shader;
+  // slot of the material in the bindless table, set by the derived material
+  uint32_t index{};
 
   BaseMaterial() = delete;
   explicit BaseMaterial(GPU const &gpu, mem::MemoryManager &memoryManager,
-                        BaseShader const *shader);
+                        BindlessTable &bindlessTable, BaseShader const *shader);
   virtual ~BaseMaterial() = default;
 };
 } // namespace cbl::gfx
\ No newline at end of file
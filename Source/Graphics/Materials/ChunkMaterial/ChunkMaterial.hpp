@@ -1,15 +1,28 @@
 #pragma once
 
+#include <filesystem>
+#include <vector>
+
 #include "Graphics/Materials/BaseMaterial.hpp"
 
 namespace cbl::gfx {
 struct ChunkMaterial : public BaseMaterial {
 private:
   mem::Texture texture{};
+  uint32_t mTextureIndex{};
 
 public:
+  // layers of the block texture array, in order
+  static std::vector<std::filesystem::path> const TexturePaths;
+  // TexturePaths with their mip chains, written by TextureCooker on the first run
+  static std::filesystem::path const CookedTexturePath;
+
   ChunkMaterial() = delete;
-  ChunkMaterial(GPU const &gpu, mem::MemoryManager &memoryManager, BaseShader const *shader);
+  ChunkMaterial(GPU const &gpu, mem::MemoryManager &memoryManager, BindlessTable &bindlessTable,
+                BaseShader const *shader, mem::CookedTexture const &cookedTexture);
+  // for when the texture could not be cooked, its mip chain is generated on the GPU instead
+  ChunkMaterial(GPU const &gpu, mem::MemoryManager &memoryManager, BindlessTable &bindlessTable,
+                BaseShader const *shader, std::vector<mem::TextureImage> const &images);
   ~ChunkMaterial() override;
 };
 } // namespace cbl::gfx
@@ -13,5 +13,6 @@ struct Buffer {
   VkBuffer buffer{};
   VkDeviceSize size{};
   MemoryManager *memoryManager{};
+  void *mappedData = nullptr; // only for buffers created by MemoryManager::createMappedBuffer
 };
 } // namespace flex
@@ -9,27 +9,31 @@ VkFormat Image::findSupportedFormat(GPU const &gpu,
                                           VkImageTiling const &requestedTiling,
                                           VkFormatFeatureFlags const &requestedFeatures) {
   for (VkFormat format : formatChoices) {
-    VkFormatProperties properties{};
-    vkGetPhysicalDeviceFormatProperties(gpu.physicalDevice, format, &properties);
-
-    switch (requestedTiling) {
-    case VK_IMAGE_TILING_OPTIMAL:
-      if ((properties.optimalTilingFeatures & requestedFeatures) == requestedFeatures) {
-        return format;
-      }
-      break;
-    case VK_IMAGE_TILING_LINEAR:
-      if ((properties.linearTilingFeatures & requestedFeatures) == requestedFeatures) {
-        return format;
-      }
-      break;
-    case VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT:
-    case VK_IMAGE_TILING_MAX_ENUM:
-      break;
+    if (isFormatSupported(gpu, format, requestedTiling, requestedFeatures)) {
+      return format;
     }
   }
 
   throw std::runtime_error("Failed to find supported VkFormat");
 }
 
+bool Image::isFormatSupported(GPU const &gpu, VkFormat const &format,
+                              VkImageTiling const &requestedTiling,
+                              VkFormatFeatureFlags const &requestedFeatures) {
+  VkFormatProperties properties{};
+  vkGetPhysicalDeviceFormatProperties(gpu.physicalDevice, format, &properties);
+
+  switch (requestedTiling) {
+  case VK_IMAGE_TILING_OPTIMAL:
+    return (properties.optimalTilingFeatures & requestedFeatures) == requestedFeatures;
+  case VK_IMAGE_TILING_LINEAR:
+    return (properties.linearTilingFeatures & requestedFeatures) == requestedFeatures;
+  case VK_IMAGE_TILING_DRM_FORMAT_MODIFIER_EXT:
+  case VK_IMAGE_TILING_MAX_ENUM:
+    break;
+  }
+
+  return false;
+}
+
 } // namespace flex
\ No newline at end of file
@@ -20,7 +20,12 @@ public:
   VkExtent2D extent{};
   VkImageAspectFlags aspect{};
   uint32_t layers{1};
+  uint32_t mipLevels{1};
 
+  [[nodiscard]] static bool isFormatSupported(GPU const &gpu, VkFormat const &format,
+                                              VkImageTiling const &requestedTiling,
+                                              VkFormatFeatureFlags const &requestedFeatures);
+  // first of formatChoices with every requested feature, throws when none of them has
   static VkFormat findSupportedFormat(GPU const &gpu, std::vector<VkFormat> const &formatChoices,
                                       VkImageTiling const &requestedTiling,
                                       VkFormatFeatureFlags const &requestedFeatures);
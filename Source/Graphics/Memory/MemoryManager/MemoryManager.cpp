@@ -1,20 +1,29 @@
 #include "MemoryManager.hpp"
 
+#include <array>
 #include <thread>
 
 #include "External/stb_image/stb_image.h"
 
+#include "Core/Trace/Trace.hpp"
 #include "Graphics/CommandBufferRecorder/CommandBufferRecorder.hpp"
 #include "Graphics/Utils/VulkanHelpers.hpp"
 
 namespace cbl::gfx::mem {
 
-MemoryManager::MemoryManager(GPU const &gpu) : mGPU{gpu} {
+MemoryManager::MemoryManager(GPU const &gpu)
+    : mGPU{gpu}, mTransferTimeline{gpu, gpu.transferQueue},
+      mUploadProfiler{gpu, mTransferTimeline, gpu.queueFamilyIndices.transfer},
+      mGraphicsTimeline{gpu, gpu.graphicsQueue} {
 
   VmaAllocatorCreateInfo allocatorCreateInfo{};
   allocatorCreateInfo.instance = mGPU.instance;
   allocatorCreateInfo.physicalDevice = mGPU.physicalDevice;
   allocatorCreateInfo.device = mGPU.device;
+  if (mGPU.supportsMemoryBudget) {
+    allocatorCreateInfo.vulkanApiVersion = VK_API_VERSION_1_1;
+    allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+  }
 
   validateVkResult(vmaCreateAllocator(&allocatorCreateInfo, &mAllocator));
 
@@ -27,27 +36,54 @@ MemoryManager::MemoryManager(GPU const &gpu) : mGPU{gpu} {
   validateVkResult(
       vkCreateCommandPool(mGPU.device, &commandPoolCreateInfo, nullptr, &mCommandPool));
 
-  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
-  commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  commandBufferAllocateInfo.commandPool = mCommandPool;
-  commandBufferAllocateInfo.commandBufferCount = 1;
-
+  commandPoolCreateInfo.queueFamilyIndex = mGPU.queueFamilyIndices.graphics;
   validateVkResult(
-      vkAllocateCommandBuffers(mGPU.device, &commandBufferAllocateInfo, &mCommandBuffer));
+      vkCreateCommandPool(mGPU.device, &commandPoolCreateInfo, nullptr, &mGraphicsCommandPool));
 }
 
 MemoryManager::~MemoryManager() {
   mGPU.waitIdle();
+  collectFinishedUploads();
+  vkDestroyCommandPool(mGPU.device, mGraphicsCommandPool, nullptr);
   vkDestroyCommandPool(mGPU.device, mCommandPool, nullptr);
   vmaDestroyAllocator(mAllocator);
 }
 
+void MemoryManager::trackAllocation(VmaAllocation const &allocation,
+                                    AllocationCategory const &category) {
+  // offset by one, a null user data is an allocation that is not tracked
+  vmaSetAllocationUserData(mAllocator, allocation,
+                           reinterpret_cast<void *>(static_cast<uintptr_t>(category) + 1));
+
+  AllocationCounter &counter = mAllocationCounters[static_cast<size_t>(category)];
+  counter.count++;
+  counter.bytes += getAllocationSize(allocation);
+}
+
+void MemoryManager::untrackAllocation(VmaAllocation const &allocation) {
+  if (allocation == VK_NULL_HANDLE) {
+    return;
+  }
+
+  VmaAllocationInfo allocationInfo{};
+  vmaGetAllocationInfo(mAllocator, allocation, &allocationInfo);
+  if (allocationInfo.pUserData == nullptr) {
+    return;
+  }
+
+  size_t const category = reinterpret_cast<uintptr_t>(allocationInfo.pUserData) - 1;
+  AllocationCounter &counter = mAllocationCounters[category];
+  counter.count--;
+  counter.bytes -= allocationInfo.size;
+}
+
 void MemoryManager::allocateBuffer(VkBufferCreateInfo const &bufferInfo,
-                                   VmaAllocationCreateInfo const &allocInfo, Buffer &buffer) {
+                                   VmaAllocationCreateInfo const &allocInfo,
+                                   AllocationCategory const &category, Buffer &buffer) {
 
   validateVkResult(vmaCreateBuffer(mAllocator, &bufferInfo, &allocInfo, &buffer.buffer,
                                    &buffer.allocation, nullptr));
+  trackAllocation(buffer.allocation, category);
   buffer.size = bufferInfo.size;
   buffer.memoryManager = this;
   buffer.isValid = true;
@@ -67,19 +103,196 @@ Buffer MemoryManager::createStagingBuffer(VkDeviceSize const &bufferSize) {
   allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_ONLY;
 
   Buffer stagingBuffer{};
-  allocateBuffer(bufferCreateInfo, allocationCreateInfo, stagingBuffer);
+  allocateBuffer(bufferCreateInfo, allocationCreateInfo, AllocationCategory::eStaging,
+                 stagingBuffer);
   return stagingBuffer;
 }
 
-void MemoryManager::destroyBufferOnFenceTrigger(Buffer buffer, VkFence fence) const {
-  vkWaitForFences(mGPU.device, 1, &fence, VK_TRUE, UINT64_MAX);
-  vkDestroyFence(mGPU.device, fence, nullptr);
-  destroyBuffer(buffer);
+VkCommandBuffer MemoryManager::acquireUploadCommandBuffer() {
+  collectFinishedUploads();
+
+  if (!mFreeCommandBuffers.empty()) {
+    VkCommandBuffer commandBuffer = mFreeCommandBuffers.back();
+    mFreeCommandBuffers.pop_back();
+    return commandBuffer;
+  }
+
+  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+  commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  commandBufferAllocateInfo.commandPool = mCommandPool;
+  commandBufferAllocateInfo.commandBufferCount = 1;
+
+  VkCommandBuffer commandBuffer{};
+  validateVkResult(
+      vkAllocateCommandBuffers(mGPU.device, &commandBufferAllocateInfo, &commandBuffer));
+  return commandBuffer;
+}
+
+void MemoryManager::submitUpload(VkCommandBuffer &commandBuffer, Buffer const &stagingBuffer) {
+  CommandBufferRecorder recorder{commandBuffer};
+  uint64_t const timelineValue = recorder.submit(mTransferTimeline);
+  mUploadProfiler.endBatch(timelineValue);
+
+  mPendingUploads.push_back(PendingUpload{timelineValue, commandBuffer, stagingBuffer});
+}
+
+VkCommandBuffer MemoryManager::acquireGraphicsCommandBuffer() {
+  collectFinishedUploads();
+
+  if (!mFreeGraphicsCommandBuffers.empty()) {
+    VkCommandBuffer commandBuffer = mFreeGraphicsCommandBuffers.back();
+    mFreeGraphicsCommandBuffers.pop_back();
+    return commandBuffer;
+  }
+
+  VkCommandBufferAllocateInfo commandBufferAllocateInfo{};
+  commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  commandBufferAllocateInfo.commandPool = mGraphicsCommandPool;
+  commandBufferAllocateInfo.commandBufferCount = 1;
+
+  VkCommandBuffer commandBuffer{};
+  validateVkResult(
+      vkAllocateCommandBuffers(mGPU.device, &commandBufferAllocateInfo, &commandBuffer));
+  return commandBuffer;
+}
+
+void MemoryManager::submitGraphicsUpload(VkCommandBuffer &commandBuffer,
+                                         Buffer const &stagingBuffer) {
+  CommandBufferRecorder recorder{commandBuffer};
+  uint64_t const timelineValue = recorder.submit(mGraphicsTimeline);
+
+  mPendingGraphicsUploads.push_back(PendingUpload{timelineValue, commandBuffer, stagingBuffer});
+}
+
+void MemoryManager::collectFinishedUploads() {
+  CBL_TRACE_SCOPE("MemoryManager::collectFinishedUploads");
+  mUploadProfiler.collect();
+
+  while (!mPendingUploads.empty() &&
+         mTransferTimeline.isComplete(mPendingUploads.front().timelineValue)) {
+    PendingUpload &upload = mPendingUploads.front();
+
+    destroyBuffer(upload.stagingBuffer);
+    mFreeCommandBuffers.push_back(upload.commandBuffer);
+
+    mPendingUploads.pop_front();
+  }
+
+  while (!mPendingGraphicsUploads.empty() &&
+         mGraphicsTimeline.isComplete(mPendingGraphicsUploads.front().timelineValue)) {
+    PendingUpload &upload = mPendingGraphicsUploads.front();
+
+    destroyBuffer(upload.stagingBuffer);
+    mFreeGraphicsCommandBuffers.push_back(upload.commandBuffer);
+
+    mPendingGraphicsUploads.pop_front();
+  }
+}
+
+void MemoryManager::beginFrame() { vmaSetCurrentFrameIndex(mAllocator, ++mFrameIndex); }
+
+MemoryBudget MemoryManager::getBudget() const {
+  VkPhysicalDeviceMemoryProperties const *memoryProperties = nullptr;
+  vmaGetMemoryProperties(mAllocator, &memoryProperties);
+
+  std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> heapBudgets{};
+  vmaGetBudget(mAllocator, heapBudgets.data());
+
+  MemoryBudget budget{};
+  for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+    if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+      budget.usage += heapBudgets[i].usage;
+      budget.budget += heapBudgets[i].budget;
+    }
+  }
+
+  return budget;
+}
+
+VkDeviceSize MemoryManager::getAllocationSize(VmaAllocation const &allocation) const {
+  VmaAllocationInfo allocationInfo{};
+  vmaGetAllocationInfo(mAllocator, allocation, &allocationInfo);
+  return allocationInfo.size;
+}
+
+VkDeviceSize MemoryManager::getTextureBytes() const {
+  return getAllocationCounter(AllocationCategory::eTexture).bytes;
 }
 
-void MemoryManager::destroyBuffer(Buffer &buffer) const {
+AllocationCounter const &
+MemoryManager::getAllocationCounter(AllocationCategory const &category) const {
+  return mAllocationCounters[static_cast<size_t>(category)];
+}
+
+MemoryStats MemoryManager::calculateStats() const {
+  CBL_TRACE_SCOPE("MemoryManager::calculateStats");
+  VkPhysicalDeviceMemoryProperties const *memoryProperties = nullptr;
+  vmaGetMemoryProperties(mAllocator, &memoryProperties);
+
+  std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> heapBudgets{};
+  vmaGetBudget(mAllocator, heapBudgets.data());
+
+  VmaStats vmaStats{};
+  vmaCalculateStats(mAllocator, &vmaStats);
+
+  MemoryStats stats{};
+  stats.categories = mAllocationCounters;
+
+  for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++) {
+    MemoryHeapStats heap{};
+    heap.size = memoryProperties->memoryHeaps[i].size;
+    heap.deviceLocal = memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    heap.usage = heapBudgets[i].usage;
+    heap.budget = heapBudgets[i].budget;
+    heap.blockCount = vmaStats.memoryHeap[i].blockCount;
+    heap.allocationCount = vmaStats.memoryHeap[i].allocationCount;
+    heap.usedBytes = vmaStats.memoryHeap[i].usedBytes;
+    heap.unusedBytes = vmaStats.memoryHeap[i].unusedBytes;
+    stats.heaps.push_back(heap);
+  }
+
+  return stats;
+}
+
+Timeline &MemoryManager::getTransferTimeline() { return mTransferTimeline; }
+
+GpuProfiler &MemoryManager::getUploadProfiler() { return mUploadProfiler; }
+
+void MemoryManager::destroyBuffer(Buffer &buffer) {
+  untrackAllocation(buffer.allocation);
   vmaDestroyBuffer(mAllocator, buffer.buffer, buffer.allocation);
   buffer.isValid = false;
+  buffer.mappedData = nullptr;
+}
+
+Buffer MemoryManager::createMappedBuffer(VkDeviceSize const &size,
+                                         VkBufferUsageFlags const &usage) {
+  VkBufferCreateInfo bufferCreateInfo{};
+  bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  bufferCreateInfo.size = size;
+  bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  bufferCreateInfo.usage = usage;
+
+  // coherent, so the CPU writes never have to be flushed
+  VmaAllocationCreateInfo allocationCreateInfo{};
+  allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+  allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+  allocationCreateInfo.requiredFlags =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+  Buffer buffer{};
+  VmaAllocationInfo allocationInfo{};
+  validateVkResult(vmaCreateBuffer(mAllocator, &bufferCreateInfo, &allocationCreateInfo,
+                                   &buffer.buffer, &buffer.allocation, &allocationInfo));
+  trackAllocation(buffer.allocation, AllocationCategory::eMapped);
+  buffer.size = size;
+  buffer.memoryManager = this;
+  buffer.isValid = true;
+  buffer.mappedData = allocationInfo.pMappedData;
+
+  return buffer;
 }
 
 void MemoryManager::generateMeshBuffer(Mesh &mesh) {
@@ -96,12 +309,13 @@ void MemoryManager::generateMeshBuffer(Mesh &mesh) {
   VmaAllocationCreateInfo allocationCreateInfo{};
   allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
 
-  allocateBuffer(bufferCreateInfo, allocationCreateInfo, mesh.buffer);
+  allocateBuffer(bufferCreateInfo, allocationCreateInfo, AllocationCategory::eMesh, mesh.buffer);
 
   updateMeshBuffer(mesh);
 }
 
 void MemoryManager::updateMeshBuffer(Mesh &mesh) {
+  CBL_TRACE_SCOPE("MemoryManager::updateMeshBuffer");
   Buffer stagingBuffer = createStagingBuffer(mesh.getRequiredBufferSize());
 
   void *mappedMemory;
@@ -111,80 +325,162 @@ void MemoryManager::updateMeshBuffer(Mesh &mesh) {
          mesh.getVerticesSize());
   vmaUnmapMemory(mAllocator, stagingBuffer.allocation);
 
-  VkFenceCreateInfo fenceCreateInfo{};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-  VkFence bufferCopiedFence{};
-  validateVkResult(vkCreateFence(mGPU.device, &fenceCreateInfo, nullptr, &bufferCopiedFence));
+  VkCommandBuffer commandBuffer = acquireUploadCommandBuffer();
 
-  CommandBufferRecorder recorder{mCommandBuffer};
+  CommandBufferRecorder recorder{commandBuffer};
   recorder.beginOneTime()
+      .beginProfiling(mUploadProfiler)
+      .beginProfileScope(mUploadProfiler, "Mesh upload")
       .copyBuffer(stagingBuffer, mesh.buffer)
       .addMeshBufferMemoryBarrier(mesh.buffer, mGPU.queueFamilyIndices)
-      .end()
-      .submit(mGPU.transferQueue, bufferCopiedFence);
+      .endProfileScope(mUploadProfiler)
+      .end();
+
+  submitUpload(commandBuffer, stagingBuffer);
+}
+
+TextureImage MemoryManager::decodeTextureImage(std::filesystem::path const &path) {
+  CBL_TRACE_SCOPE("MemoryManager::decodeTextureImage");
+  int width, height, channels;
+  stbi_uc *pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
 
-  destroyBufferOnFenceTrigger(stagingBuffer, bufferCopiedFence);
+  if (pixels == nullptr) {
+    throw std::runtime_error("Failed to load image : " + path.string());
+  }
+
+  // STBI_rgb_alpha always gives 4 channels, whatever the file contains
+  TextureImage image{static_cast<uint32_t>(width), static_cast<uint32_t>(height), {}};
+  image.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * STBI_rgb_alpha);
+  stbi_image_free(pixels);
+
+  return image;
 }
 
 Texture MemoryManager::createTexture(std::vector<std::filesystem::path> const &texturePaths,
                                      bool const &arrayTexture) {
-  std::vector<stbi_uc *> imagesData;
-  imagesData.reserve(texturePaths.size());
-
-  int maxWidth{}, maxHeight{}, maxChannels{};
+  std::vector<TextureImage> images;
+  images.reserve(texturePaths.size());
 
   for (std::filesystem::path const &path : texturePaths) {
-    int width, height, channels;
-    stbi_uc *pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    images.push_back(decodeTextureImage(path));
+  }
 
-    if (pixels == nullptr) {
-      throw std::runtime_error("Failed to load image : " + path.string());
-    }
+  return createTexture(images, arrayTexture);
+}
 
-    maxWidth = std::max(width, maxWidth);
-    maxHeight = std::max(height, maxHeight);
-    maxChannels = std::max(channels, maxChannels);
+Texture MemoryManager::createTexture(std::vector<TextureImage> const &images,
+                                     bool const &arrayTexture) {
+  CBL_TRACE_SCOPE("MemoryManager::createTexture");
+  if (images.empty()) {
+    throw std::invalid_argument("A texture needs at least one image");
+  }
 
-    imagesData.push_back(pixels);
+  uint32_t const width = images[0].width;
+  uint32_t const height = images[0].height;
+  for (TextureImage const &image : images) {
+    if (image.width != width || image.height != height) {
+      throw std::invalid_argument("The layers of a texture must all have the same size");
+    }
   }
 
-  VkDeviceSize imageSize = maxWidth * maxHeight * maxChannels;
-  VkDeviceSize bufferSize = imageSize * imagesData.size();
+  VkDeviceSize imageSize = images[0].pixels.size();
+  VkDeviceSize bufferSize = imageSize * images.size();
 
   Buffer stagingBuffer = createStagingBuffer(bufferSize);
 
   void *data;
   vmaMapMemory(mAllocator, stagingBuffer.allocation, &data);
-  for (size_t i = 0, offset = 0; i < imagesData.size(); i++, offset += imageSize) {
-    memcpy(static_cast<char *>(data) + offset, imagesData[i], imageSize);
+  for (size_t i = 0, offset = 0; i < images.size(); i++, offset += imageSize) {
+    memcpy(static_cast<char *>(data) + offset, images[i].pixels.data(), imageSize);
   }
   vmaUnmapMemory(mAllocator, stagingBuffer.allocation);
 
+  VkFormat const format = VK_FORMAT_R8G8B8A8_SRGB;
+  VkImageViewType const viewType =
+      arrayTexture ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+
   Texture texture{};
-  texture.image = createImage(
-      {static_cast<uint32_t>(maxWidth), static_cast<uint32_t>(maxHeight)},
-      static_cast<uint32_t>(imagesData.size()), VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
-      arrayTexture ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D);
+  if (!canGenerateMipmaps(format)) {
+    texture.image = createImage({width, height}, static_cast<uint32_t>(images.size()), format,
+                                VK_IMAGE_TILING_OPTIMAL,
+                                VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                VK_IMAGE_ASPECT_COLOR_BIT, viewType, 1,
+                                AllocationCategory::eTexture);
+
+    uploadTexture(stagingBuffer, texture.image, {0});
+    texture.sampler = createSampler(texture.image.mipLevels);
+    return texture;
+  }
 
-  VkFenceCreateInfo fenceCreateInfo{};
-  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+  texture.image = createImage(
+      {width, height}, static_cast<uint32_t>(images.size()), format, VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+          VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_IMAGE_ASPECT_COLOR_BIT, viewType, TextureCooker::getMipLevelCount(width, height),
+      AllocationCategory::eTexture);
 
-  VkFence transferFinishedFence{};
-  validateVkResult(vkCreateFence(mGPU.device, &fenceCreateInfo, nullptr, &transferFinishedFence));
+  // the copy and the blits are recorded together on the graphics queue, so no ownership transfer
+  // or cross queue wait is needed between them
+  VkCommandBuffer commandBuffer = acquireGraphicsCommandBuffer();
 
-  CommandBufferRecorder recorder{mCommandBuffer};
+  CommandBufferRecorder recorder{commandBuffer};
   recorder.beginOneTime()
       .transitionImageLayout(texture.image, VK_IMAGE_LAYOUT_UNDEFINED,
                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mGPU.queueFamilyIndices)
       .copyBufferToImage(stagingBuffer, texture.image)
-      .transitionImageLayout(texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      .generateMipmaps(texture.image, mGPU.queueFamilyIndices)
+      .end();
+
+  submitGraphicsUpload(commandBuffer, stagingBuffer);
+  texture.sampler = createSampler(texture.image.mipLevels);
+
+  return texture;
+}
+
+Texture MemoryManager::createTexture(CookedTexture const &cookedTexture,
+                                     bool const &arrayTexture) {
+  CBL_TRACE_SCOPE("MemoryManager::createTexture");
+  Buffer stagingBuffer = createStagingBuffer(cookedTexture.pixelsSize);
+
+  // the mapped pages are read once, straight into the staging buffer
+  void *data;
+  vmaMapMemory(mAllocator, stagingBuffer.allocation, &data);
+  memcpy(data, cookedTexture.pixels, cookedTexture.pixelsSize);
+  vmaUnmapMemory(mAllocator, stagingBuffer.allocation);
+
+  Texture texture{};
+  texture.image = createImage(
+      {cookedTexture.width, cookedTexture.height}, cookedTexture.layers, VK_FORMAT_R8G8B8A8_SRGB,
+      VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_IMAGE_ASPECT_COLOR_BIT, arrayTexture ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+      cookedTexture.mipLevels, AllocationCategory::eTexture);
+
+  uploadTexture(stagingBuffer, texture.image, cookedTexture.levelOffsets);
+  texture.sampler = createSampler(texture.image.mipLevels);
+
+  return texture;
+}
+
+void MemoryManager::uploadTexture(Buffer const &stagingBuffer, Image const &image,
+                                  std::vector<VkDeviceSize> const &levelOffsets) {
+  VkCommandBuffer commandBuffer = acquireUploadCommandBuffer();
+
+  CommandBufferRecorder recorder{commandBuffer};
+  recorder.beginOneTime()
+      .beginProfiling(mUploadProfiler)
+      .beginProfileScope(mUploadProfiler, "Texture upload")
+      .transitionImageLayout(image, VK_IMAGE_LAYOUT_UNDEFINED,
+                             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mGPU.queueFamilyIndices)
+      .copyBufferToImage(stagingBuffer, image, levelOffsets)
+      .transitionImageLayout(image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
                              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mGPU.queueFamilyIndices)
-      .end()
-      .submit(mGPU.transferQueue, transferFinishedFence);
+      .endProfileScope(mUploadProfiler)
+      .end();
 
-  destroyBufferOnFenceTrigger(stagingBuffer, transferFinishedFence);
+  submitUpload(commandBuffer, stagingBuffer);
+}
 
+VkSampler MemoryManager::createSampler(uint32_t const &mipLevels) const {
   VkSamplerCreateInfo samplerCreateInfo{};
   samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
   samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
@@ -196,16 +492,24 @@ Texture MemoryManager::createTexture(std::vector<std::filesystem::path> const &t
   samplerCreateInfo.maxAnisotropy = 0;
   samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
   samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
-  samplerCreateInfo.compareEnable = VK_TRUE;
-  samplerCreateInfo.compareOp = VK_COMPARE_OP_LESS;
+  // comparison is only meant for depth textures
+  samplerCreateInfo.compareEnable = VK_FALSE;
+  samplerCreateInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+  // blocks keep their sharp texels up close, and blend between mips in the distance
   samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   samplerCreateInfo.mipLodBias = 0.0f;
   samplerCreateInfo.minLod = 0.0f;
-  samplerCreateInfo.maxLod = 0.0f;
+  samplerCreateInfo.maxLod = static_cast<float>(mipLevels);
 
-  validateVkResult(vkCreateSampler(mGPU.device, &samplerCreateInfo, nullptr, &texture.sampler));
+  VkSampler sampler{};
+  validateVkResult(vkCreateSampler(mGPU.device, &samplerCreateInfo, nullptr, &sampler));
+  return sampler;
+}
 
-  return texture;
+bool MemoryManager::canGenerateMipmaps(VkFormat const &format) const {
+  return Image::isFormatSupported(mGPU, format, VK_IMAGE_TILING_OPTIMAL,
+                                  VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
 }
 
 void MemoryManager::destroyTexture(Texture &texture) {
@@ -217,11 +521,13 @@ Image MemoryManager::createImage(VkExtent2D const &extent, uint32_t const &layer
                                  VkFormat const &format, VkImageTiling const &tiling,
                                  VkImageUsageFlags const &usage,
                                  VkImageAspectFlags const &imageAspect,
-                                 VkImageViewType const &viewType) {
+                                 VkImageViewType const &viewType, uint32_t const &mipLevels,
+                                 AllocationCategory const &category) {
   Image image{};
   image.format = format;
   image.extent = extent;
   image.layers = layers;
+  image.mipLevels = mipLevels;
   image.aspect = imageAspect;
 
   // image memory
@@ -231,7 +537,7 @@ Image MemoryManager::createImage(VkExtent2D const &extent, uint32_t const &layer
   imageCreateInfo.extent.width = extent.width;
   imageCreateInfo.extent.height = extent.height;
   imageCreateInfo.extent.depth = 1;
-  imageCreateInfo.mipLevels = 1;
+  imageCreateInfo.mipLevels = mipLevels;
   imageCreateInfo.arrayLayers = layers;
   imageCreateInfo.format = format;
   imageCreateInfo.tiling = tiling;
@@ -245,6 +551,7 @@ Image MemoryManager::createImage(VkExtent2D const &extent, uint32_t const &layer
 
   validateVkResult(vmaCreateImage(mAllocator, &imageCreateInfo, &allocationCreateInfo, &image.image,
                                   &image.allocation, nullptr));
+  trackAllocation(image.allocation, category);
 
   createImageView(image, viewType);
 
@@ -253,6 +560,7 @@ Image MemoryManager::createImage(VkExtent2D const &extent, uint32_t const &layer
 
 void MemoryManager::destroyImage(Image &image) {
   vkDestroyImageView(mGPU.device, image.imageView, nullptr);
+  untrackAllocation(image.allocation);
   vmaDestroyImage(mAllocator, image.image, image.allocation);
 }
 
@@ -261,7 +569,7 @@ void MemoryManager::createImageView(Image &image, VkImageViewType const &viewTyp
   VkImageSubresourceRange subresourceRange{};
   subresourceRange.aspectMask = image.aspect;
   subresourceRange.baseMipLevel = 0;
-  subresourceRange.levelCount = 1;
+  subresourceRange.levelCount = image.mipLevels;
   subresourceRange.baseArrayLayer = 0;
   subresourceRange.layerCount = image.layers;
 
@@ -281,4 +589,22 @@ void MemoryManager::createImageView(Image &image, VkImageViewType const &viewTyp
 
   validateVkResult(vkCreateImageView(mGPU.device, &imageViewCreateInfo, nullptr, &image.imageView));
 }
+
+char const *toString(AllocationCategory const &category) {
+  switch (category) {
+  case AllocationCategory::eMesh:
+    return "mesh";
+  case AllocationCategory::eStaging:
+    return "staging";
+  case AllocationCategory::eMapped:
+    return "mapped";
+  case AllocationCategory::eTexture:
+    return "texture";
+  case AllocationCategory::eAttachment:
+    return "attachment";
+  }
+
+  return "unknown";
+}
+
 } // namespace cbl::gfx::mem
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <vector>
 
 #include "External/vk_mem_alloc/vk_mem_alloc.h"
 
@@ -8,42 +12,143 @@
 #include "Graphics/Memory/Buffer/Buffer.hpp"
 #include "Graphics/Memory/Image/Image.hpp"
 #include "Graphics/Memory/Texture/Texture.hpp"
+#include "Graphics/Memory/Texture/TextureCooker.hpp"
 #include "Graphics/Mesh/Mesh.hpp"
+#include "Graphics/Profiler/GpuProfiler.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
 
 namespace cbl::gfx::mem {
+// summed over the device local heaps, in bytes
+struct MemoryBudget {
+  VkDeviceSize usage{};  // by this process, including what was not allocated through VMA
+  VkDeviceSize budget{}; // what the process can use before allocations start failing or paging
+};
+
+// what the allocations made through the MemoryManager are used for
+enum class AllocationCategory : uint8_t { eMesh, eStaging, eMapped, eTexture, eAttachment };
+constexpr size_t AllocationCategoryCount = 5;
+
+[[nodiscard]] char const *toString(AllocationCategory const &category);
+
+struct AllocationCounter {
+  uint32_t count{};
+  VkDeviceSize bytes{};
+};
+
+struct MemoryHeapStats {
+  VkDeviceSize size{};
+  bool deviceLocal{};
+  VkDeviceSize usage{};
+  VkDeviceSize budget{};
+  uint32_t blockCount{};      // VkDeviceMemory objects
+  uint32_t allocationCount{}; // suballocated from the blocks
+  VkDeviceSize usedBytes{};
+  VkDeviceSize unusedBytes{}; // allocated from the driver but not handed out, or fragmented
+};
+
+struct MemoryStats {
+  std::array<AllocationCounter, AllocationCategoryCount> categories{};
+  std::vector<MemoryHeapStats> heaps{};
+};
+
 struct MemoryManager {
 private:
   GPU const &mGPU;
   VmaAllocator mAllocator{};
+  uint32_t mFrameIndex = 0;
+  std::array<AllocationCounter, AllocationCategoryCount> mAllocationCounters{};
+
+  Timeline mTransferTimeline;
+  GpuProfiler mUploadProfiler;
+
+  struct PendingUpload {
+    uint64_t timelineValue{};
+    VkCommandBuffer commandBuffer{};
+    Buffer stagingBuffer{};
+  };
 
   VkCommandPool mCommandPool{};
-  VkCommandBuffer mCommandBuffer{};
+  std::vector<VkCommandBuffer> mFreeCommandBuffers{};
+  std::deque<PendingUpload> mPendingUploads{};
+
+  // uploads that blit, which transfer queues cannot do
+  Timeline mGraphicsTimeline;
+  VkCommandPool mGraphicsCommandPool{};
+  std::vector<VkCommandBuffer> mFreeGraphicsCommandBuffers{};
+  std::deque<PendingUpload> mPendingGraphicsUploads{};
+
+  // the category is kept in the allocation's user data, so that it can be counted out on release
+  void trackAllocation(VmaAllocation const &allocation, AllocationCategory const &category);
+  void untrackAllocation(VmaAllocation const &allocation);
 
   void allocateBuffer(VkBufferCreateInfo const &bufferInfo,
-                      VmaAllocationCreateInfo const &allocInfo, Buffer &buffer);
+                      VmaAllocationCreateInfo const &allocInfo, AllocationCategory const &category,
+                      Buffer &buffer);
   Buffer createStagingBuffer(VkDeviceSize const &bufferSize);
 
-  void destroyBufferOnFenceTrigger(Buffer buffer, VkFence fence) const;
+  [[nodiscard]] VkCommandBuffer acquireUploadCommandBuffer();
+  void submitUpload(VkCommandBuffer &commandBuffer, Buffer const &stagingBuffer);
+  [[nodiscard]] VkCommandBuffer acquireGraphicsCommandBuffer();
+  void submitGraphicsUpload(VkCommandBuffer &commandBuffer, Buffer const &stagingBuffer);
+
+  // copies every level of stagingBuffer to image and submits it, the staging buffer is released
+  // once the copy is done
+  void uploadTexture(Buffer const &stagingBuffer, Image const &image,
+                     std::vector<VkDeviceSize> const &levelOffsets);
+  [[nodiscard]] VkSampler createSampler(uint32_t const &mipLevels) const;
+  [[nodiscard]] bool canGenerateMipmaps(VkFormat const &format) const;
 
 public:
   MemoryManager() = delete;
   explicit MemoryManager(GPU const &gpu);
   ~MemoryManager();
 
-  void destroyBuffer(Buffer &buffer) const;
+  void destroyBuffer(Buffer &buffer);
+  // Host visible buffer that stays mapped until destroyed, for data the CPU rewrites often. Writes
+  // through mappedData are seen by the GPU without any flush or copy
+  [[nodiscard]] Buffer createMappedBuffer(VkDeviceSize const &size,
+                                          VkBufferUsageFlags const &usage);
+
+  // Releases the staging resources of every upload the GPU has finished, without blocking
+  void collectFinishedUploads();
+  // once per frame, refreshes the budget from the driver
+  void beginFrame();
+  // Reported by the driver with VK_EXT_memory_budget, estimated from the heap sizes otherwise
+  [[nodiscard]] MemoryBudget getBudget() const;
+  [[nodiscard]] VkDeviceSize getAllocationSize(VmaAllocation const &allocation) const;
+  // held by the textures that were created and not destroyed yet
+  [[nodiscard]] VkDeviceSize getTextureBytes() const;
+  [[nodiscard]] AllocationCounter const &
+  getAllocationCounter(AllocationCategory const &category) const;
+  // Walks every allocation of VMA, too slow to be called every frame
+  [[nodiscard]] MemoryStats calculateStats() const;
+  [[nodiscard]] Timeline &getTransferTimeline();
+  [[nodiscard]] GpuProfiler &getUploadProfiler();
 
   void generateMeshBuffer(Mesh &mesh);
   void updateMeshBuffer(Mesh &mesh);
 
+  // Only reads the file, so it can be called from any thread
+  [[nodiscard]] static TextureImage decodeTextureImage(std::filesystem::path const &path);
   [[nodiscard]] Texture createTexture(std::vector<std::filesystem::path> const &texturePaths,
                                       bool const &arrayTexture);
+  // Every image of an array texture must have the same size. The mip chain is generated on the
+  // graphics queue when the format can be blitted, otherwise the texture only has level 0
+  [[nodiscard]] Texture createTexture(std::vector<TextureImage> const &images,
+                                      bool const &arrayTexture);
+  // uploads the whole mip chain straight from the mapped file
+  [[nodiscard]] Texture createTexture(CookedTexture const &cookedTexture,
+                                      bool const &arrayTexture);
   void destroyTexture(Texture &texture);
 
   [[nodiscard]] Image createImage(VkExtent2D const &extent, uint32_t const &layers,
                                   VkFormat const &format, VkImageTiling const &tiling,
                                   VkImageUsageFlags const &usage,
                                   VkImageAspectFlags const &imageAspect,
-                                  VkImageViewType const &viewType);
+                                  VkImageViewType const &viewType,
+                                  uint32_t const &mipLevels = 1,
+                                  AllocationCategory const &category =
+                                      AllocationCategory::eAttachment);
   void createImageView(Image &image, VkImageViewType const &viewType) const;
   void destroyImage(Image &image);
 };
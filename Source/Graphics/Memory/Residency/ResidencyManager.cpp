@@ -0,0 +1,184 @@
+#include "ResidencyManager.hpp"
+
+#include <algorithm>
+
+#include "Core/Trace/Trace.hpp"
+
+namespace cbl::gfx::mem {
+
+ResidencyManager::ResidencyManager(MemoryManager &memoryManager, Timeline &graphicsTimeline,
+                                   float const &budgetFraction)
+    : mMemoryManager{memoryManager}, mGraphicsTimeline{graphicsTimeline},
+      mBudgetFraction{budgetFraction} {}
+
+void ResidencyManager::releaseFinishedEvictions() {
+  Timeline &transferTimeline = mMemoryManager.getTransferTimeline();
+
+  while (!mPendingEvictions.empty() &&
+         mGraphicsTimeline.isComplete(mPendingEvictions.front().graphicsValue) &&
+         transferTimeline.isComplete(mPendingEvictions.front().transferValue)) {
+    PendingEviction &eviction = mPendingEvictions.front();
+
+    mPendingEvictionBytes -= mMemoryManager.getAllocationSize(eviction.buffer.allocation);
+    mMemoryManager.destroyBuffer(eviction.buffer);
+
+    mPendingEvictions.pop_front();
+  }
+}
+
+VkDeviceSize ResidencyManager::getProjectedUsage() const {
+  VkDeviceSize const usage = mMemoryManager.getBudget().usage;
+  return usage > mPendingEvictionBytes ? usage - mPendingEvictionBytes : 0;
+}
+
+VkDeviceSize ResidencyManager::getTargetUsage() const {
+  return static_cast<VkDeviceSize>(static_cast<double>(mMemoryManager.getBudget().budget) *
+                                   mBudgetFraction);
+}
+
+void ResidencyManager::sortByDistance(std::vector<Mesh> const &meshes,
+                                      glm::vec3 const &cameraPosition) {
+  std::sort(mOrder.begin(), mOrder.end(), [&meshes, &cameraPosition](size_t a, size_t b) {
+    return glm::distance(cameraPosition, meshes[a].getWorldCenter()) <
+           glm::distance(cameraPosition, meshes[b].getWorldCenter());
+  });
+}
+
+void ResidencyManager::upload(Mesh &mesh) {
+  mMemoryManager.generateMeshBuffer(mesh);
+  mResidentMeshBytes += mesh.buffer.size;
+  mResidentMeshCount++;
+}
+
+void ResidencyManager::evict(Mesh &mesh) {
+  // frames in flight and uploads still in progress may use the buffer, it is destroyed once they
+  // are done
+  PendingEviction eviction{mGraphicsTimeline.getLastSubmittedValue(),
+                           mMemoryManager.getTransferTimeline().getLastSubmittedValue(),
+                           mesh.buffer};
+  mPendingEvictionBytes += mMemoryManager.getAllocationSize(eviction.buffer.allocation);
+  mPendingEvictions.push_back(eviction);
+
+  mResidentMeshBytes -= mesh.buffer.size;
+  mResidentMeshCount--;
+  mEvictedMeshCount++;
+  mesh.buffer = Buffer{};
+}
+
+void ResidencyManager::evictFarthest(std::vector<Mesh> &meshes, glm::vec3 const &cameraPosition,
+                                     VkDeviceSize const &target, float const &minDistance) {
+  mCandidates.clear();
+  for (size_t i = 0; i < meshes.size(); i++) {
+    if (meshes[i].buffer.isValid && (i >= mVisible.size() || mVisible[i] == 0)) {
+      mCandidates.emplace_back(glm::distance(cameraPosition, meshes[i].getWorldCenter()), i);
+    }
+  }
+
+  std::sort(mCandidates.begin(), mCandidates.end(),
+            [](std::pair<float, size_t> const &a, std::pair<float, size_t> const &b) {
+              return a.first > b.first;
+            });
+
+  for (auto const &[distance, meshIndex] : mCandidates) {
+    if (getProjectedUsage() <= target || distance < minDistance) {
+      return;
+    }
+
+    evict(meshes[meshIndex]);
+  }
+}
+
+void ResidencyManager::makeResident(std::vector<Mesh> &meshes, glm::vec3 const &cameraPosition) {
+  CBL_TRACE_SCOPE("ResidencyManager::makeResident");
+  releaseFinishedEvictions();
+
+  mOrder.clear();
+  for (size_t i = 0; i < meshes.size(); i++) {
+    if (!meshes[i].buffer.isValid && meshes[i].getRequiredBufferSize() > 0) {
+      mOrder.push_back(i);
+    }
+  }
+
+  sortByDistance(meshes, cameraPosition);
+
+  VkDeviceSize const target = getTargetUsage();
+  for (size_t const meshIndex : mOrder) {
+    if (getProjectedUsage() + meshes[meshIndex].getRequiredBufferSize() > target) {
+      return;
+    }
+
+    upload(meshes[meshIndex]);
+  }
+}
+
+void ResidencyManager::update(std::vector<Mesh> &meshes, std::vector<size_t> const &visibleMeshes,
+                              glm::vec3 const &cameraPosition) {
+  CBL_TRACE_SCOPE("ResidencyManager::update");
+  releaseFinishedEvictions();
+
+  mVisible.assign(meshes.size(), 0);
+  mOrder.clear();
+  for (size_t const meshIndex : visibleMeshes) {
+    mVisible[meshIndex] = 1;
+
+    if (!meshes[meshIndex].buffer.isValid && meshes[meshIndex].getRequiredBufferSize() > 0) {
+      mOrder.push_back(meshIndex);
+    }
+  }
+
+  VkDeviceSize const target = getTargetUsage();
+  if (getProjectedUsage() > target) {
+    evictFarthest(meshes, cameraPosition, target, 0.0f);
+  }
+
+  if (mOrder.empty()) {
+    return;
+  }
+
+  sortByDistance(meshes, cameraPosition);
+
+  VkDeviceSize uploadedBytes = 0;
+  for (size_t const meshIndex : mOrder) {
+    Mesh &mesh = meshes[meshIndex];
+    VkDeviceSize const size = mesh.getRequiredBufferSize();
+
+    if (uploadedBytes > 0 && uploadedBytes + size > mMaxUploadBytesPerFrame) {
+      return;
+    }
+
+    // only makes room with chunks that are farther away, closer ones matter more
+    if (getProjectedUsage() + size > target) {
+      evictFarthest(meshes, cameraPosition, target > size ? target - size : 0,
+                    glm::distance(cameraPosition, mesh.getWorldCenter()));
+    }
+
+    upload(mesh);
+    uploadedBytes += size;
+  }
+}
+
+void ResidencyManager::releaseAll(std::vector<Mesh> &meshes) {
+  releaseFinishedEvictions();
+
+  for (Mesh &mesh : meshes) {
+    if (mesh.buffer.isValid) {
+      mMemoryManager.destroyBuffer(mesh.buffer);
+    }
+  }
+
+  mResidentMeshBytes = 0;
+  mResidentMeshCount = 0;
+  mEvictedMeshCount = 0;
+}
+
+VkDeviceSize ResidencyManager::getResidentMeshBytes() const { return mResidentMeshBytes; }
+
+VkDeviceSize ResidencyManager::getTextureBytes() const { return mMemoryManager.getTextureBytes(); }
+
+uint32_t ResidencyManager::getResidentMeshCount() const { return mResidentMeshCount; }
+
+uint32_t ResidencyManager::getEvictedMeshCount() const { return mEvictedMeshCount; }
+
+float ResidencyManager::getBudgetFraction() const { return mBudgetFraction; }
+
+} // namespace cbl::gfx::mem
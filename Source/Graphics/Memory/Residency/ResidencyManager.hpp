@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Graphics/Memory/Buffer/Buffer.hpp"
+#include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
+#include "Graphics/Mesh/Mesh.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
+
+namespace cbl::gfx::mem {
+// Keeps the mesh buffers of a world under a fraction of the device memory budget. When usage gets
+// over it, the buffers of the chunks farthest from the camera are evicted, and chunks that become
+// visible again are uploaded on demand from the vertices the meshes keep on the CPU. Only chunks
+// that pass culling count as visible. They are never evicted, so a view that does not fit goes
+// over the target instead of flickering
+struct ResidencyManager {
+private:
+  struct PendingEviction {
+    uint64_t graphicsValue{};
+    uint64_t transferValue{};
+    Buffer buffer{};
+  };
+
+  // uploads at most this much per frame, the rest waits for the next frames
+  static constexpr VkDeviceSize mMaxUploadBytesPerFrame = 32ull << 20u;
+
+  MemoryManager &mMemoryManager;
+  Timeline &mGraphicsTimeline;
+  float mBudgetFraction;
+
+  VkDeviceSize mResidentMeshBytes = 0;
+  uint32_t mResidentMeshCount = 0;
+  uint32_t mEvictedMeshCount = 0; // since the world was loaded
+
+  // evicted buffers the GPU may still use, with the bytes they still hold
+  std::deque<PendingEviction> mPendingEvictions{};
+  VkDeviceSize mPendingEvictionBytes = 0;
+
+  // scratch, kept between frames for its allocations
+  std::vector<uint8_t> mVisible{};
+  std::vector<size_t> mOrder{};
+  std::vector<std::pair<float, size_t>> mCandidates{}; // distance to the camera, mesh index
+
+  void releaseFinishedEvictions();
+  // what usage will be once the pending evictions are released
+  [[nodiscard]] VkDeviceSize getProjectedUsage() const;
+  [[nodiscard]] VkDeviceSize getTargetUsage() const;
+  // closest to the camera first
+  void sortByDistance(std::vector<Mesh> const &meshes, glm::vec3 const &cameraPosition);
+
+  void upload(Mesh &mesh);
+  void evict(Mesh &mesh);
+  // evicts resident meshes that are not visible, farthest first, until usage is under target or
+  // the next one is closer than minDistance
+  void evictFarthest(std::vector<Mesh> &meshes, glm::vec3 const &cameraPosition,
+                     VkDeviceSize const &target, float const &minDistance);
+
+public:
+  ResidencyManager() = delete;
+  ResidencyManager(ResidencyManager const &) = delete;
+  // budgetFraction is the part of the device memory budget the process tries to stay under
+  ResidencyManager(MemoryManager &memoryManager, Timeline &graphicsTimeline,
+                   float const &budgetFraction);
+
+  void operator=(ResidencyManager const &) = delete;
+
+  // Uploads the meshes closest to cameraPosition first, until the target is reached. The others
+  // are uploaded once they are visible
+  void makeResident(std::vector<Mesh> &meshes, glm::vec3 const &cameraPosition);
+  // Once per frame, before recording draws. Uploads the visible meshes that were evicted and
+  // evicts far away ones when usage is over the target. visibleMeshes is the culled draw list
+  void update(std::vector<Mesh> &meshes, std::vector<size_t> const &visibleMeshes,
+              glm::vec3 const &cameraPosition);
+  // the GPU must be idle, the meshes are about to be destroyed
+  void releaseAll(std::vector<Mesh> &meshes);
+
+  [[nodiscard]] VkDeviceSize getResidentMeshBytes() const;
+  // textures are few and always resident, they only count against the budget
+  [[nodiscard]] VkDeviceSize getTextureBytes() const;
+  [[nodiscard]] uint32_t getResidentMeshCount() const;
+  [[nodiscard]] uint32_t getEvictedMeshCount() const;
+  [[nodiscard]] float getBudgetFraction() const;
+};
+} // namespace cbl::gfx::mem
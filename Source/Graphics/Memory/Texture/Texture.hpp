@@ -1,10 +1,20 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include <vulkan/vulkan.h>
 
 #include "Graphics/Memory/Image/Image.hpp"
 
 namespace cbl::gfx::mem {
+// RGBA8 pixels decoded from an image file, not on the GPU yet
+struct TextureImage {
+  uint32_t width{};
+  uint32_t height{};
+  std::vector<uint8_t> pixels{};
+};
+
 struct Texture {
   Image image{};
   VkSampler sampler{};
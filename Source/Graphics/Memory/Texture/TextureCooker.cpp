@@ -0,0 +1,252 @@
+#include "TextureCooker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+
+#include "Core/Trace/Trace.hpp"
+#include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
+
+namespace cbl::gfx::mem {
+
+namespace {
+constexpr size_t BytesPerTexel = 4;
+
+std::array<float, 256> const &getSrgbToLinearTable() {
+  static std::array<float, 256> const table = []() {
+    std::array<float, 256> values{};
+    for (size_t i = 0; i < values.size(); i++) {
+      float const srgb = static_cast<float>(i) / 255.0f;
+      values[i] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+    }
+    return values;
+  }();
+  return table;
+}
+
+uint8_t linearToSrgb(float const &linear) {
+  float const srgb =
+      linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+} // namespace
+
+uint32_t TextureCooker::getMipLevelCount(uint32_t const &width, uint32_t const &height) {
+  uint32_t levels = 1;
+  for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+    levels++;
+  }
+  return levels;
+}
+
+std::vector<VkDeviceSize> TextureCooker::getLevelOffsets(uint32_t const &width,
+                                                         uint32_t const &height,
+                                                         uint32_t const &layers,
+                                                         uint32_t const &mipLevels,
+                                                         VkDeviceSize &totalSize) {
+  std::vector<VkDeviceSize> offsets{};
+  offsets.reserve(mipLevels);
+
+  totalSize = 0;
+  for (uint32_t level = 0; level < mipLevels; level++) {
+    offsets.push_back(totalSize);
+    VkDeviceSize const levelWidth = std::max(width >> level, 1u);
+    VkDeviceSize const levelHeight = std::max(height >> level, 1u);
+    totalSize += levelWidth * levelHeight * BytesPerTexel * layers;
+  }
+
+  return offsets;
+}
+
+uint64_t
+TextureCooker::getSourceFingerprint(std::vector<std::filesystem::path> const &sources) {
+  // FNV-1a over the path, size and modification time of every source
+  uint64_t hash = 14695981039346656037ull;
+  auto const mix = [&hash](void const *data, size_t const &size) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<uint8_t const *>(data)[i];
+      hash *= 1099511628211ull;
+    }
+  };
+
+  for (std::filesystem::path const &source : sources) {
+    std::error_code error{};
+    uint64_t const size = std::filesystem::file_size(source, error);
+    if (error) {
+      return 0;
+    }
+    int64_t const writeTime =
+        std::filesystem::last_write_time(source, error).time_since_epoch().count();
+    if (error) {
+      return 0;
+    }
+
+    std::string const name = source.generic_string();
+    mix(name.data(), name.size());
+    mix(&size, sizeof(size));
+    mix(&writeTime, sizeof(writeTime));
+  }
+
+  return hash == 0 ? 1 : hash;
+}
+
+TextureImage TextureCooker::downsample(TextureImage const &image) {
+  std::array<float, 256> const &toLinear = getSrgbToLinearTable();
+
+  TextureImage result{std::max(image.width / 2, 1u), std::max(image.height / 2, 1u), {}};
+  result.pixels.resize(static_cast<size_t>(result.width) * result.height * BytesPerTexel);
+
+  for (uint32_t y = 0; y < result.height; y++) {
+    // odd sizes repeat their last row and column
+    uint32_t const sourceRows[2] = {std::min(y * 2, image.height - 1),
+                                    std::min(y * 2 + 1, image.height - 1)};
+
+    for (uint32_t x = 0; x < result.width; x++) {
+      uint32_t const sourceColumns[2] = {std::min(x * 2, image.width - 1),
+                                         std::min(x * 2 + 1, image.width - 1)};
+
+      std::array<float, BytesPerTexel> sum{};
+      for (uint32_t const &row : sourceRows) {
+        for (uint32_t const &column : sourceColumns) {
+          uint8_t const *texel =
+              &image.pixels[(static_cast<size_t>(row) * image.width + column) * BytesPerTexel];
+          sum[0] += toLinear[texel[0]];
+          sum[1] += toLinear[texel[1]];
+          sum[2] += toLinear[texel[2]];
+          sum[3] += static_cast<float>(texel[3]);
+        }
+      }
+
+      uint8_t *texel = &result.pixels[(static_cast<size_t>(y) * result.width + x) * BytesPerTexel];
+      texel[0] = linearToSrgb(sum[0] / 4.0f);
+      texel[1] = linearToSrgb(sum[1] / 4.0f);
+      texel[2] = linearToSrgb(sum[2] / 4.0f);
+      // alpha is stored linearly
+      texel[3] = static_cast<uint8_t>(sum[3] / 4.0f + 0.5f);
+    }
+  }
+
+  return result;
+}
+
+void TextureCooker::cook(std::vector<std::filesystem::path> const &sources,
+                         std::filesystem::path const &outputPath, jobs::Scheduler &jobs) {
+  CBL_TRACE_SCOPE("TextureCooker::cook");
+  if (sources.empty()) {
+    throw std::invalid_argument("A texture needs at least one image");
+  }
+
+  // mipChains[layer][level]. Jobs must not throw, errors are rethrown once they are all done
+  std::vector<std::vector<TextureImage>> mipChains(sources.size());
+  std::vector<std::exception_ptr> errors(sources.size());
+  jobs.parallelFor(sources.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t layer = begin; layer < end; layer++) {
+      try {
+        std::vector<TextureImage> &chain = mipChains[layer];
+        chain.push_back(MemoryManager::decodeTextureImage(sources[layer]));
+
+        uint32_t const levels = getMipLevelCount(chain[0].width, chain[0].height);
+        for (uint32_t level = 1; level < levels; level++) {
+          chain.push_back(downsample(chain.back()));
+        }
+      } catch (...) {
+        errors[layer] = std::current_exception();
+      }
+    }
+  });
+
+  for (std::exception_ptr const &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  TextureImage const &base = mipChains[0][0];
+  for (std::vector<TextureImage> const &chain : mipChains) {
+    if (chain[0].width != base.width || chain[0].height != base.height) {
+      throw std::invalid_argument("The layers of a texture must all have the same size");
+    }
+  }
+
+  FileHeader header{};
+  std::memcpy(header.magic, mMagic, sizeof(mMagic));
+  header.version = mVersion;
+  header.sourceFingerprint = getSourceFingerprint(sources);
+  header.width = base.width;
+  header.height = base.height;
+  header.layers = static_cast<uint32_t>(sources.size());
+  header.mipLevels = static_cast<uint32_t>(mipChains[0].size());
+
+  std::filesystem::create_directories(outputPath.parent_path());
+
+  // written to a temporary file first, an interrupted cook never leaves a truncated texture
+  std::filesystem::path const temporaryPath = outputPath.string() + ".tmp";
+  {
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+    for (uint32_t level = 0; level < header.mipLevels; level++) {
+      for (std::vector<TextureImage> const &chain : mipChains) {
+        file.write(reinterpret_cast<char const *>(chain[level].pixels.data()),
+                   static_cast<std::streamsize>(chain[level].pixels.size()));
+      }
+    }
+
+    if (!file) {
+      throw std::runtime_error("Failed to write " + temporaryPath.string());
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, outputPath);
+}
+
+CookedTexture TextureCooker::load(std::vector<std::filesystem::path> const &sources,
+                                  std::filesystem::path const &cookedPath, jobs::Scheduler &jobs) {
+  CBL_TRACE_SCOPE("TextureCooker::load");
+  uint64_t const fingerprint = getSourceFingerprint(sources);
+
+  // a file that cannot be used is cooked again, but only once
+  for (bool cooked = false;; cooked = true) {
+    if (std::filesystem::exists(cookedPath)) {
+      CookedTexture texture{};
+      texture.file = MappedFile{cookedPath};
+
+      FileHeader header{};
+      bool valid = texture.file.size() >= sizeof(header);
+      if (valid) {
+        std::memcpy(&header, texture.file.data(), sizeof(header));
+        valid = std::memcmp(header.magic, mMagic, sizeof(mMagic)) == 0 &&
+                header.version == mVersion && header.layers == sources.size() &&
+                header.mipLevels == getMipLevelCount(header.width, header.height) &&
+                (fingerprint == 0 || header.sourceFingerprint == fingerprint);
+      }
+
+      if (valid) {
+        texture.width = header.width;
+        texture.height = header.height;
+        texture.layers = header.layers;
+        texture.mipLevels = header.mipLevels;
+        texture.levelOffsets = getLevelOffsets(header.width, header.height, header.layers,
+                                               header.mipLevels, texture.pixelsSize);
+        texture.pixels = static_cast<uint8_t const *>(texture.file.data()) + sizeof(header);
+        valid = texture.file.size() == sizeof(header) + texture.pixelsSize;
+      }
+
+      if (valid) {
+        return texture;
+      }
+    }
+
+    if (cooked) {
+      throw std::runtime_error("Cooked texture " + cookedPath.string() + " is invalid");
+    }
+
+    cook(sources, cookedPath, jobs);
+  }
+}
+
+} // namespace cbl::gfx::mem
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Core/IO/MappedFile.hpp"
+#include "Core/Jobs/Scheduler.hpp"
+#include "Graphics/Memory/Texture/Texture.hpp"
+
+namespace cbl::gfx::mem {
+// RGBA8 texture array with its whole mip chain, mapped from a file written by TextureCooker. The
+// layers of a level are contiguous, so the pixels go to the GPU in one copy with a region per level
+struct CookedTexture {
+  MappedFile file{};
+  uint32_t width{};
+  uint32_t height{};
+  uint32_t layers{};
+  uint32_t mipLevels{};
+
+  uint8_t const *pixels = nullptr; // inside file
+  VkDeviceSize pixelsSize{};
+  std::vector<VkDeviceSize> levelOffsets{}; // from pixels
+};
+
+struct TextureCooker {
+private:
+  struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceFingerprint;
+    uint32_t width;
+    uint32_t height;
+    uint32_t layers;
+    uint32_t mipLevels;
+  };
+
+  static constexpr char mMagic[4] = {'C', 'B', 'L', 'T'};
+  static constexpr uint32_t mVersion = 1;
+
+  // changes when a source is edited, 0 when one of them does not exist
+  [[nodiscard]] static uint64_t getSourceFingerprint(
+      std::vector<std::filesystem::path> const &sources);
+  [[nodiscard]] static TextureImage downsample(TextureImage const &image);
+
+public:
+  TextureCooker() = delete;
+  TextureCooker(TextureCooker const &) = delete;
+  ~TextureCooker() = delete;
+
+  [[nodiscard]] static uint32_t getMipLevelCount(uint32_t const &width, uint32_t const &height);
+  [[nodiscard]] static std::vector<VkDeviceSize>
+  getLevelOffsets(uint32_t const &width, uint32_t const &height, uint32_t const &layers,
+                  uint32_t const &mipLevels, VkDeviceSize &totalSize);
+
+  // Decodes the sources in parallel, builds their mip chains with an sRGB correct box filter and
+  // writes them as one texture array
+  static void cook(std::vector<std::filesystem::path> const &sources,
+                   std::filesystem::path const &outputPath, jobs::Scheduler &jobs);
+  // Maps cookedPath, cooking it first when it is missing or its sources changed since. A cooked
+  // file without its sources, as shipped in a release, is used as is
+  [[nodiscard]] static CookedTexture load(std::vector<std::filesystem::path> const &sources,
+                                          std::filesystem::path const &cookedPath,
+                                          jobs::Scheduler &jobs);
+};
+} // namespace cbl::gfx::mem
@@ -1,15 +1,32 @@
 #include "Mesh.hpp"
 
+#include <limits>
+
 #include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
 
 namespace cbl::gfx {
 Mesh::Mesh(std::vector<uint32_t> const &indices, std::vector<Vertex> const &vertices) {
   this->indices = indices;
   this->vertices = vertices;
+
+  if (vertices.empty()) {
+    return;
+  }
+
+  glm::vec3 minimum{std::numeric_limits<float>::max()};
+  glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+  for (Vertex const &vertex : vertices) {
+    minimum = glm::min(minimum, vertex.position);
+    maximum = glm::max(maximum, vertex.position);
+  }
+  center = (minimum + maximum) * 0.5f;
+  radius = glm::length(maximum - minimum) * 0.5f;
 }
 
 size_t Mesh::getIndicesSize() const { return sizeof(indices[0]) * indices.size(); }
 size_t Mesh::getVerticesSize() const { return sizeof(vertices[0]) * vertices.size(); }
 size_t Mesh::getRequiredBufferSize() const { return getIndicesSize() + getVerticesSize(); }
 
+glm::vec3 Mesh::getWorldCenter() const { return glm::vec3{position * glm::vec4{center, 1.0f}}; }
+
 } // namespace cbl::gfx
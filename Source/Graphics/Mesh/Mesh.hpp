@@ -12,10 +12,14 @@ struct Mesh {
   std::vector<uint32_t> indices{};
   std::vector<Vertex> vertices{};
   glm::mat4 position{1};
+  glm::vec3 center{0}; // of the vertices bounding box, in model space
+  float radius{0};      // of the sphere around center that holds the bounding box
+  uint32_t materialIndex{0}; // into World::materials
   mem::Buffer buffer{};
 
   [[nodiscard]] size_t getIndicesSize() const;
   [[nodiscard]] size_t getVerticesSize() const;
   [[nodiscard]] size_t getRequiredBufferSize() const;
+  [[nodiscard]] glm::vec3 getWorldCenter() const;
 };
 } // namespace cbl::gfx
\ No newline at end of file
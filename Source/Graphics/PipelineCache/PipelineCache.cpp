@@ -0,0 +1,108 @@
+#include "PipelineCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "Core/Trace/Trace.hpp"
+#include "Graphics/Utils/VulkanHelpers.hpp"
+
+namespace cbl::gfx {
+
+PipelineCache::PipelineCache(GPU const &gpu, std::filesystem::path path)
+    : mGPU{gpu}, mPath{std::move(path)} {
+  CBL_TRACE_SCOPE("PipelineCache::PipelineCache");
+  vkGetPhysicalDeviceProperties(mGPU.physicalDevice, &mDeviceProperties);
+
+  std::vector<char> const initialData = loadData();
+
+  VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+  pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  pipelineCacheCreateInfo.initialDataSize = initialData.size();
+  pipelineCacheCreateInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+  validateVkResult(
+      vkCreatePipelineCache(mGPU.device, &pipelineCacheCreateInfo, nullptr, &pipelineCache));
+}
+
+PipelineCache::~PipelineCache() {
+  try {
+    save();
+  } catch (std::exception const &exception) {
+    // losing the cache only costs the next startup some time
+    std::cerr << "Failed to save the pipeline cache : " << exception.what() << '\n';
+  }
+
+  vkDestroyPipelineCache(mGPU.device, pipelineCache, nullptr);
+}
+
+PipelineCache::FileHeader PipelineCache::makeHeader(uint64_t const &dataSize) const {
+  FileHeader header{};
+  std::memcpy(header.magic, mMagic, sizeof(mMagic));
+  header.version = mVersion;
+  header.vendorId = mDeviceProperties.vendorID;
+  header.deviceId = mDeviceProperties.deviceID;
+  header.driverVersion = mDeviceProperties.driverVersion;
+  std::memcpy(header.pipelineCacheUuid, mDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+  header.reserved = 0;
+  header.dataSize = dataSize;
+  return header;
+}
+
+std::vector<char> PipelineCache::loadData() const {
+  std::ifstream file{mPath, std::ios::binary};
+  if (!file) {
+    return {};
+  }
+
+  FileHeader header{};
+  file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+  FileHeader const expectedHeader = makeHeader(header.dataSize);
+  if (!file || std::memcmp(&header, &expectedHeader, sizeof(header)) != 0) {
+    // written by another device, driver or engine version, start from an empty cache
+    return {};
+  }
+
+  // a truncated or corrupted file could otherwise ask for any amount of memory
+  std::error_code error{};
+  uintmax_t const fileSize = std::filesystem::file_size(mPath, error);
+  if (error || fileSize < sizeof(header) || header.dataSize != fileSize - sizeof(header)) {
+    return {};
+  }
+
+  std::vector<char> data(header.dataSize);
+  file.read(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    return {};
+  }
+
+  return data;
+}
+
+void PipelineCache::save() const {
+  size_t dataSize = 0;
+  validateVkResult(vkGetPipelineCacheData(mGPU.device, pipelineCache, &dataSize, nullptr));
+
+  std::vector<char> data(dataSize);
+  validateVkResult(vkGetPipelineCacheData(mGPU.device, pipelineCache, &dataSize, data.data()));
+  data.resize(dataSize);
+
+  std::filesystem::path const temporaryPath = mPath.string() + ".tmp";
+  {
+    std::ofstream file{temporaryPath, std::ios::binary | std::ios::trunc};
+    FileHeader const header = makeHeader(data.size());
+    file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+    if (!file) {
+      throw std::runtime_error("Failed to write " + temporaryPath.string());
+    }
+  }
+
+  std::filesystem::rename(temporaryPath, mPath);
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Graphics/GPU/GPU.hpp"
+
+namespace cbl::gfx {
+// VkPipelineCache shared by every pipeline, loaded from a file at startup and written back when
+// destroyed. The file is ignored when it was written by another device or driver version
+struct PipelineCache {
+private:
+  // prepended to the Vulkan data, whose own header has no driver version. Compared with memcmp,
+  // so it must not contain any padding
+  struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vendorId;
+    uint32_t deviceId;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUuid[VK_UUID_SIZE];
+    uint32_t reserved; // always 0, aligns dataSize
+    uint64_t dataSize;
+  };
+  static_assert(sizeof(FileHeader) == 48, "FileHeader must not contain padding");
+
+  static constexpr char mMagic[4] = {'C', 'B', 'L', 'C'};
+  static constexpr uint32_t mVersion = 1;
+
+  GPU const &mGPU;
+  std::filesystem::path mPath;
+  VkPhysicalDeviceProperties mDeviceProperties{};
+
+  [[nodiscard]] FileHeader makeHeader(uint64_t const &dataSize) const;
+  [[nodiscard]] std::vector<char> loadData() const;
+
+public:
+  static constexpr char const *DefaultPath = "pipeline_cache.bin";
+
+  VkPipelineCache pipelineCache{};
+
+  PipelineCache() = delete;
+  PipelineCache(PipelineCache const &) = delete;
+  explicit PipelineCache(GPU const &gpu, std::filesystem::path path = DefaultPath);
+  ~PipelineCache();
+
+  void operator=(PipelineCache const &) = delete;
+
+  // writes to a temporary file first, an interrupted save never leaves a corrupt cache behind
+  void save() const;
+};
+} // namespace cbl::gfx
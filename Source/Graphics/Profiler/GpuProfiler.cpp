@@ -0,0 +1,236 @@
+#include "GpuProfiler.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "External/imgui/imgui.h"
+
+#include "Graphics/Utils/VulkanHelpers.hpp"
+
+namespace cbl::gfx {
+
+GpuProfiler::GpuProfiler(GPU const &gpu, Timeline &timeline, uint32_t const &queueFamilyIndex)
+    : mGPU{gpu}, mTimeline{timeline} {
+  VkPhysicalDeviceProperties physicalDeviceProperties{};
+  vkGetPhysicalDeviceProperties(mGPU.physicalDevice, &physicalDeviceProperties);
+
+  uint32_t propertiesCount;
+  vkGetPhysicalDeviceQueueFamilyProperties(mGPU.physicalDevice, &propertiesCount, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilyProperties{propertiesCount};
+  vkGetPhysicalDeviceQueueFamilyProperties(mGPU.physicalDevice, &propertiesCount,
+                                           queueFamilyProperties.data());
+
+  VkQueueFamilyProperties const &queueFamily = queueFamilyProperties[queueFamilyIndex];
+  uint32_t const timestampValidBits = queueFamily.timestampValidBits;
+
+  // vkCmdResetQueryPool is not allowed on transfer only queues
+  mResetOnHost = mGPU.supportsHostQueryReset;
+  VkQueueFlags const resetQueueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+  bool const canReset = mResetOnHost || (queueFamily.queueFlags & resetQueueFlags) != 0;
+
+  mEnabled = canReset && timestampValidBits > 0 &&
+             physicalDeviceProperties.limits.timestampPeriod > 0.0f;
+  mNanosecondsPerTick = physicalDeviceProperties.limits.timestampPeriod;
+  mTimestampMask = timestampValidBits >= 64 ? UINT64_MAX : (uint64_t{1} << timestampValidBits) - 1;
+}
+
+GpuProfiler::~GpuProfiler() {
+  if (!mSubmittedBatches.empty()) {
+    mTimeline.wait(mBatches[mSubmittedBatches.back()].timelineValue);
+  }
+
+  for (QueryBatch const &batch : mBatches) {
+    vkDestroyQueryPool(mGPU.device, batch.queryPool, nullptr);
+  }
+}
+
+size_t GpuProfiler::acquireBatch() {
+  if (!mFreeBatches.empty()) {
+    size_t const batchIndex = mFreeBatches.back();
+    mFreeBatches.pop_back();
+    return batchIndex;
+  }
+
+  VkQueryPoolCreateInfo queryPoolCreateInfo{};
+  queryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  queryPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  queryPoolCreateInfo.queryCount = mMaxScopesPerBatch * 2;
+
+  QueryBatch batch{};
+  validateVkResult(
+      vkCreateQueryPool(mGPU.device, &queryPoolCreateInfo, nullptr, &batch.queryPool));
+
+  mBatches.push_back(batch);
+  return mBatches.size() - 1;
+}
+
+void GpuProfiler::beginBatch(VkCommandBuffer const &commandBuffer) {
+  if (!mEnabled) {
+    return;
+  }
+
+  mRecordingBatch = acquireBatch();
+  mOpenScopes.clear();
+
+  QueryBatch &batch = mBatches[*mRecordingBatch];
+  batch.scopeNames.clear();
+
+  // free batches are done being used by the GPU, they can be reset right away
+  if (mResetOnHost) {
+    vkResetQueryPool(mGPU.device, batch.queryPool, 0, mMaxScopesPerBatch * 2);
+  } else {
+    vkCmdResetQueryPool(commandBuffer, batch.queryPool, 0, mMaxScopesPerBatch * 2);
+  }
+}
+
+void GpuProfiler::beginScope(VkCommandBuffer const &commandBuffer, std::string const &name) {
+  if (!mRecordingBatch) {
+    return;
+  }
+
+  QueryBatch &batch = mBatches[*mRecordingBatch];
+  if (batch.scopeNames.size() >= mMaxScopesPerBatch) {
+    // scopes past the limit are not measured, but still have to be balanced by endScope
+    mOpenScopes.push_back(mMaxScopesPerBatch);
+    return;
+  }
+
+  auto const scopeIndex = static_cast<uint32_t>(batch.scopeNames.size());
+  batch.scopeNames.push_back(name);
+  mOpenScopes.push_back(scopeIndex);
+
+  vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.queryPool,
+                      scopeIndex * 2);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer const &commandBuffer) {
+  if (!mRecordingBatch || mOpenScopes.empty()) {
+    return;
+  }
+
+  uint32_t const scopeIndex = mOpenScopes.back();
+  mOpenScopes.pop_back();
+
+  if (scopeIndex >= mMaxScopesPerBatch) {
+    return;
+  }
+
+  vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                      mBatches[*mRecordingBatch].queryPool, scopeIndex * 2 + 1);
+}
+
+void GpuProfiler::endBatch(uint64_t const &timelineValue) {
+  if (!mRecordingBatch) {
+    return;
+  }
+
+  mBatches[*mRecordingBatch].timelineValue = timelineValue;
+  mSubmittedBatches.push_back(*mRecordingBatch);
+  mRecordingBatch.reset();
+}
+
+void GpuProfiler::readBatch(QueryBatch &batch) {
+  if (batch.scopeNames.empty()) {
+    return;
+  }
+
+  std::vector<uint64_t> timestamps(batch.scopeNames.size() * 2);
+
+  // the submission is complete, so the results are available without VK_QUERY_RESULT_WAIT_BIT
+  if (vkGetQueryPoolResults(mGPU.device, batch.queryPool, 0,
+                            static_cast<uint32_t>(timestamps.size()),
+                            timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS) {
+    return;
+  }
+
+  for (size_t i = 0; i < batch.scopeNames.size(); i++) {
+    uint64_t const ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & mTimestampMask;
+    double const milliseconds = static_cast<double>(ticks) * mNanosecondsPerTick / 1000000.0;
+
+    std::deque<double> &samples = mSamples[batch.scopeNames[i]];
+    samples.push_back(milliseconds);
+    if (samples.size() > mSampleWindow) {
+      samples.pop_front();
+    }
+  }
+}
+
+void GpuProfiler::collect() {
+  while (!mSubmittedBatches.empty() &&
+         mTimeline.isComplete(mBatches[mSubmittedBatches.front()].timelineValue)) {
+    size_t const batchIndex = mSubmittedBatches.front();
+    mSubmittedBatches.pop_front();
+
+    readBatch(mBatches[batchIndex]);
+    mFreeBatches.push_back(batchIndex);
+  }
+}
+
+bool GpuProfiler::isEnabled() const { return mEnabled; }
+
+std::vector<GpuProfiler::ScopeStatistics> GpuProfiler::getStatistics() const {
+  std::vector<ScopeStatistics> statistics{};
+  statistics.reserve(mSamples.size());
+
+  for (auto const &[name, samples] : mSamples) {
+    if (samples.empty()) {
+      continue;
+    }
+
+    std::vector<double> sortedSamples{samples.begin(), samples.end()};
+    std::sort(sortedSamples.begin(), sortedSamples.end());
+
+    size_t const p99Index = (sortedSamples.size() * 99 + 99) / 100 - 1;
+
+    ScopeStatistics scopeStatistics{};
+    scopeStatistics.name = name;
+    scopeStatistics.lastMs = samples.back();
+    scopeStatistics.minMs = sortedSamples.front();
+    scopeStatistics.averageMs = std::accumulate(sortedSamples.begin(), sortedSamples.end(), 0.0) /
+                                static_cast<double>(sortedSamples.size());
+    scopeStatistics.p99Ms = sortedSamples[std::min(p99Index, sortedSamples.size() - 1)];
+    scopeStatistics.sampleCount = sortedSamples.size();
+
+    statistics.push_back(scopeStatistics);
+  }
+
+  return statistics;
+}
+
+std::vector<double> GpuProfiler::getSamples(std::string const &name) const {
+  auto const samples = mSamples.find(name);
+  if (samples == mSamples.end()) {
+    return {};
+  }
+
+  return std::vector<double>{samples->second.begin(), samples->second.end()};
+}
+
+void GpuProfiler::setSampleWindow(size_t const &sampleWindow) {
+  mSampleWindow = std::max(sampleWindow, size_t{1});
+}
+
+void GpuProfiler::clearSamples() { mSamples.clear(); }
+
+void GpuProfiler::drawImGui() const {
+  if (!mEnabled) {
+    ImGui::TextUnformatted("Timestamps are not supported on this queue");
+    return;
+  }
+
+  ImGui::Text("%-16s %8s %8s %8s %8s", "Scope", "Last", "Min", "Avg", "P99");
+  for (ScopeStatistics const &scope : getStatistics()) {
+    ImGui::Text("%-16s %8.3f %8.3f %8.3f %8.3f", scope.name.c_str(), scope.lastMs, scope.minMs,
+                scope.averageMs, scope.p99Ms);
+  }
+}
+
+void GpuProfiler::writeCsv(std::ostream &stream, std::string const &queueName) const {
+  for (ScopeStatistics const &scope : getStatistics()) {
+    stream << queueName << ',' << scope.name << ',' << scope.sampleCount << ',' << scope.lastMs
+           << ',' << scope.minMs << ',' << scope.averageMs << ',' << scope.p99Ms << '\n';
+  }
+}
+
+} // namespace cbl::gfx
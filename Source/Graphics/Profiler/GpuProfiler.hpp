@@ -0,0 +1,89 @@
+#pragma once
+
+#include <deque>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Graphics/GPU/GPU.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
+
+namespace cbl::gfx {
+// Measures named scopes of GPU work with timestamp queries. Every profiled command buffer gets its
+// own query pool, whose results are only read back once the timeline reports the submission as
+// complete, so collecting never stalls.
+struct GpuProfiler {
+public:
+  struct ScopeStatistics {
+    std::string name;
+    double lastMs{};
+    double minMs{};
+    double averageMs{};
+    double p99Ms{};
+    size_t sampleCount{};
+  };
+
+private:
+  struct QueryBatch {
+    VkQueryPool queryPool{};
+    std::vector<std::string> scopeNames{}; // scope i uses queries 2i and 2i + 1
+    uint64_t timelineValue{};
+  };
+
+  static constexpr uint32_t mMaxScopesPerBatch = 32;
+  static constexpr size_t mDefaultSampleWindow = 256;
+  size_t mSampleWindow{mDefaultSampleWindow};
+
+  GPU const &mGPU;
+  Timeline &mTimeline;
+
+  bool mEnabled{false};
+  // otherwise query pools are reset by a command, which needs a graphics or compute queue
+  bool mResetOnHost{false};
+  double mNanosecondsPerTick{};
+  uint64_t mTimestampMask{};
+
+  std::vector<QueryBatch> mBatches{};
+  std::vector<size_t> mFreeBatches{};
+  std::deque<size_t> mSubmittedBatches{};
+  std::optional<size_t> mRecordingBatch{};
+  std::vector<uint32_t> mOpenScopes{};
+
+  std::map<std::string, std::deque<double>> mSamples{};
+
+  [[nodiscard]] size_t acquireBatch();
+  void readBatch(QueryBatch &batch);
+
+public:
+  GpuProfiler() = delete;
+  GpuProfiler(GpuProfiler const &) = delete;
+  GpuProfiler(GPU const &gpu, Timeline &timeline, uint32_t const &queueFamilyIndex);
+  ~GpuProfiler();
+
+  void operator=(GpuProfiler const &) = delete;
+
+  // must be recorded outside of a render pass, before any scope
+  void beginBatch(VkCommandBuffer const &commandBuffer);
+  void beginScope(VkCommandBuffer const &commandBuffer, std::string const &name);
+  void endScope(VkCommandBuffer const &commandBuffer);
+  // hands the batch over once the command buffer has been submitted on the timeline
+  void endBatch(uint64_t const &timelineValue);
+
+  void collect();
+
+  [[nodiscard]] bool isEnabled() const;
+  [[nodiscard]] std::vector<ScopeStatistics> getStatistics() const;
+  // samples of a scope in milliseconds, oldest first
+  [[nodiscard]] std::vector<double> getSamples(std::string const &name) const;
+
+  void setSampleWindow(size_t const &sampleWindow);
+  void clearSamples();
+
+  void drawImGui() const;
+  void writeCsv(std::ostream &stream, std::string const &queueName) const;
+};
+} // namespace cbl::gfx
@@ -0,0 +1,83 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace cbl::gfx {
+
+uint64_t RenderQueue::makeSortKey(uint16_t const &shaderIndex, uint16_t const &materialIndex,
+                                  float const &depth) {
+  float const clampedDepth = std::max(depth, 0.0f);
+  uint32_t depthBits;
+  std::memcpy(&depthBits, &clampedDepth, sizeof(depthBits));
+
+  return uint64_t{shaderIndex} << 48u | uint64_t{materialIndex} << 32u | depthBits;
+}
+
+void RenderQueue::clear() { mItems.clear(); }
+
+void RenderQueue::push(DrawItem const &item) { mItems.push_back(item); }
+
+void RenderQueue::sort() {
+  mSortScratch.resize(mItems.size());
+
+  for (uint32_t shift = 0; shift < 64; shift += 8) {
+    std::array<size_t, 256> offsets{};
+    for (DrawItem const &item : mItems) {
+      offsets[(item.sortKey >> shift) & 0xFFu]++;
+    }
+
+    // every key has the same byte here, the pass would not move anything
+    if (std::find(offsets.begin(), offsets.end(), mItems.size()) != offsets.end()) {
+      continue;
+    }
+
+    size_t offset = 0;
+    for (size_t &bucket : offsets) {
+      size_t const count = bucket;
+      bucket = offset;
+      offset += count;
+    }
+
+    for (DrawItem const &item : mItems) {
+      mSortScratch[offsets[(item.sortKey >> shift) & 0xFFu]++] = item;
+    }
+    mItems.swap(mSortScratch);
+  }
+}
+
+size_t RenderQueue::size() const { return mItems.size(); }
+
+std::vector<DrawItem> const &RenderQueue::getItems() const { return mItems; }
+
+void RenderQueue::writeDrawData(DrawData *drawData) const {
+  for (size_t i = 0; i < mItems.size(); i++) {
+    DrawItem const &item = mItems[i];
+
+    // chunk meshes are only ever translated, the mapped memory is written in one go
+    drawData[i] = DrawData{glm::vec3{item.mesh->position[3]}, item.material->index, 0, {}};
+  }
+}
+
+void RenderQueue::record(CommandBufferRecorder &recorder, BindlessTable const &bindlessTable,
+                         VkDescriptorSet const &drawDataSet, size_t const &begin,
+                         size_t const &end) const {
+  BaseShader const *boundShader = nullptr;
+
+  for (size_t i = begin; i < end; i++) {
+    DrawItem const &item = mItems[i];
+
+    if (item.shader != boundShader) {
+      recorder
+          .bindGraphicsShader(*item.shader)               //
+          .bindBindlessTable(*item.shader, bindlessTable) //
+          .bindDrawData(*item.shader, drawDataSet);
+      boundShader = item.shader;
+    }
+
+    recorder.drawMesh(*item.mesh, static_cast<uint32_t>(i));
+  }
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Graphics/Bindless/BindlessTable.hpp"
+#include "Graphics/CommandBufferRecorder/CommandBufferRecorder.hpp"
+#include "Graphics/DrawData/DrawDataTable.hpp"
+#include "Graphics/Materials/BaseMaterial.hpp"
+#include "Graphics/Mesh/Mesh.hpp"
+#include "Graphics/Shaders/BaseShader.hpp"
+
+namespace cbl::gfx {
+struct DrawItem {
+  uint64_t sortKey;
+  BaseShader const *shader;
+  BaseMaterial const *material;
+  Mesh const *mesh;
+};
+
+// Draws of a frame, sorted by pipeline, then material, then distance to the camera. Playback only
+// binds descriptor sets when the pipeline changes. Each draw passes its position in the queue as
+// its first instance, the shaders use it to find its DrawData
+struct RenderQueue {
+private:
+  std::vector<DrawItem> mItems{};
+  std::vector<DrawItem> mSortScratch{};
+
+public:
+  // 16 bits of pipeline, 16 bits of material, and the bits of the depth as a float, which sort
+  // like integers as long as it is positive
+  [[nodiscard]] static uint64_t makeSortKey(uint16_t const &shaderIndex,
+                                            uint16_t const &materialIndex, float const &depth);
+
+  void clear();
+  void push(DrawItem const &item);
+  // LSD radix sort on the keys, skipping the bytes that are the same for every item
+  void sort();
+
+  [[nodiscard]] size_t size() const;
+  [[nodiscard]] std::vector<DrawItem> const &getItems() const;
+
+  // one DrawData per item, in queue order
+  void writeDrawData(DrawData *drawData) const;
+
+  // records the draws in [begin, end), starting with nothing bound
+  void record(CommandBufferRecorder &recorder, BindlessTable const &bindlessTable,
+              VkDescriptorSet const &drawDataSet, size_t const &begin, size_t const &end) const;
+};
+} // namespace cbl::gfx
@@ -4,9 +4,12 @@
 #include <fstream>
 
 #include "Graphics/Utils/VulkanHelpers.hpp"
+#include "Graphics/Vertex/VertexLayout.hpp"
 
 namespace cbl::gfx {
-BaseShader::BaseShader(GPU const &gpu, VkRenderPass const &renderPass) : mGPU{gpu} {}
+BaseShader::BaseShader(GPU const &gpu, VkRenderPass const &renderPass,
+                       VkPipelineCache const &pipelineCache)
+    : mGPU{gpu}, mPipelineCache{pipelineCache} {}
 
 VkShaderModule BaseShader::createShaderModule(std::filesystem::path const &path) const {
   std::ifstream shaderFile{path.string(), std::ios::ate | std::ios::binary};
@@ -42,7 +45,8 @@ void BaseShader::createDefaultPipelineLayout() {
       vkCreatePipelineLayout(mGPU.device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout));
 }
 
-void BaseShader::createDefaultPipeline(VkRenderPass const &renderPass) {
+void BaseShader::createDefaultPipeline(VkRenderPass const &renderPass,
+                                       VkSpecializationInfo const *fragmentSpecialization) {
   std::filesystem::path shaderPath{"Shaders/" + getName() + "/" + getName()};
 
   VkShaderModule vertShaderModule = createShaderModule({shaderPath.string() + ".vert.spv"});
@@ -58,10 +62,11 @@ void BaseShader::createDefaultPipeline(VkRenderPass const &renderPass) {
   shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
   shaderStages[1].module = fragShaderModule;
   shaderStages[1].pName = "main";
+  shaderStages[1].pSpecializationInfo = fragmentSpecialization;
 
-  VkVertexInputBindingDescription bindingDescription = Vertex::getVulkanBindingDescription();
+  VkVertexInputBindingDescription bindingDescription = VertexLayout::getVulkanBindingDescription();
   std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions =
-      Vertex::getVulkanAttributeDescriptions();
+      VertexLayout::getVulkanAttributeDescriptions();
 
   VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo{};
   vertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -153,15 +158,13 @@ void BaseShader::createDefaultPipeline(VkRenderPass const &renderPass) {
   pipelineCreateInfo.subpass = 0;
   pipelineCreateInfo.basePipelineIndex = -1;
 
-  validateVkResult(
-      vkCreateGraphicsPipelines(mGPU.device, nullptr, 1, &pipelineCreateInfo, nullptr, &pipeline));
+  validateVkResult(vkCreateGraphicsPipelines(mGPU.device, mPipelineCache, 1, &pipelineCreateInfo,
+                                             nullptr, &pipeline));
 
   vkDestroyShaderModule(mGPU.device, vertShaderModule, nullptr);
   vkDestroyShaderModule(mGPU.device, fragShaderModule, nullptr);
 }
 BaseShader::~BaseShader() {
-  vkDestroyDescriptorPool(mGPU.device, descriptorPool, nullptr);
-  vkDestroyDescriptorSetLayout(mGPU.device, descriptorSetLayout, nullptr);
   vkDestroyPipeline(mGPU.device, pipeline, nullptr);
   vkDestroyPipelineLayout(mGPU.device, pipelineLayout, nullptr);
 }
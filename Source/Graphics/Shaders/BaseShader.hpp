@@ -18,19 +18,19 @@ private:
 
 protected:
   GPU const &mGPU;
+  VkPipelineCache mPipelineCache;
 
   void createDefaultPipelineLayout();
-  void createDefaultPipeline(VkRenderPass const &renderPass);
+  void createDefaultPipeline(VkRenderPass const &renderPass,
+                             VkSpecializationInfo const *fragmentSpecialization = nullptr);
 
 public:
   VkPipeline pipeline{};
   VkPipelineLayout pipelineLayout{};
 
-  VkDescriptorSetLayout descriptorSetLayout{};
-  VkDescriptorPool descriptorPool{};
-
   BaseShader() = delete;
-  BaseShader(GPU const &gpu, VkRenderPass const &renderPass);
+  BaseShader(GPU const &gpu, VkRenderPass const &renderPass,
+             VkPipelineCache const &pipelineCache);
   virtual ~BaseShader();
 
   [[nodiscard]] virtual std::string getName() = 0;
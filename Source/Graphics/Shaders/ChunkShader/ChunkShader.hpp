@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Graphics/Bindless/BindlessTable.hpp"
+#include "Graphics/DrawData/DrawDataTable.hpp"
 #include "Graphics/Shaders/BaseShader.hpp"
 
 namespace cbl::gfx {
@@ -7,7 +9,8 @@ struct ChunkShader : public BaseShader {
 private:
 public:
   ChunkShader() = delete;
-  ChunkShader(GPU const &gpu, VkRenderPass const &renderPass);
+  ChunkShader(GPU const &gpu, VkRenderPass const &renderPass, VkPipelineCache const &pipelineCache,
+              BindlessTable const &bindlessTable, DrawDataTable const &drawDataTable);
 
   [[nodiscard]] std::string getName() override;
 };
@@ -38,22 +38,58 @@ bool SwapchainSupportDetails::isUsable() const {
   return !(formats.empty() || presentModes.empty());
 }
 
-Swapchain::Swapchain(const GPU &gpu, const Window &window, mem::MemoryManager &memoryManager)
-    : mMemoryManager{memoryManager}, mGPU{gpu} {
+Swapchain::Swapchain(const GPU &gpu, const Window *window, mem::MemoryManager &memoryManager,
+                     Timeline &graphicsTimeline, EngineConfig const &config)
+    : mMemoryManager{memoryManager}, mGPU{gpu}, mGraphicsTimeline{graphicsTimeline},
+      mRequestedPresentMode{config.presentMode},
+      mRequestedImageCount{config.swapchainImageCount} {
+  if (isOffscreen()) {
+    createRenderPass();
+    createOffscreenImages(VkExtent2D{config.width, config.height});
+    return;
+  }
+
   swapchainSupportDetails = SwapchainSupportDetails{mGPU.physicalDevice, mGPU.renderSurface};
   createRenderPass();
-  createSwapchain(window);
+  createSwapchain(*window);
 }
 
 Swapchain::~Swapchain() {
-  cleanSwapchain();
-  vkDestroySwapchainKHR(mGPU.device, swapchain, nullptr);
+  mGPU.waitIdle();
+
+  for (RetiredResources &retiredResources : mRetiredResources) {
+    destroyResources(retiredResources);
+  }
+
+  RetiredResources currentResources{0, false, swapchain, frameBufferImages, depthBufferImage,
+                                    framebuffers};
+  destroyResources(currentResources);
+
   vkDestroyRenderPass(mGPU.device, renderPass, nullptr);
 }
 
 VkPresentModeKHR
 Swapchain::chooseSwapchainPresentMode(std::vector<VkPresentModeKHR> const &availablePresentModes,
+                                      EngineConfig::PresentMode const &requestedPresentMode,
                                       bool const &vsync) {
+  auto const isAvailable = [&availablePresentModes](VkPresentModeKHR const &presentMode) {
+    return std::find(availablePresentModes.begin(), availablePresentModes.end(), presentMode) !=
+           availablePresentModes.end();
+  };
+
+  switch (requestedPresentMode) {
+  case EngineConfig::PresentMode::eAuto:
+    break;
+  case EngineConfig::PresentMode::eFifo:
+    return VK_PRESENT_MODE_FIFO_KHR;
+  case EngineConfig::PresentMode::eMailbox:
+    return isAvailable(VK_PRESENT_MODE_MAILBOX_KHR) ? VK_PRESENT_MODE_MAILBOX_KHR
+                                                    : VK_PRESENT_MODE_FIFO_KHR;
+  case EngineConfig::PresentMode::eImmediate:
+    return isAvailable(VK_PRESENT_MODE_IMMEDIATE_KHR) ? VK_PRESENT_MODE_IMMEDIATE_KHR
+                                                      : VK_PRESENT_MODE_FIFO_KHR;
+  }
+
   if (vsync) {
     return VK_PRESENT_MODE_FIFO_KHR;
   }
@@ -72,6 +108,17 @@ Swapchain::chooseSwapchainPresentMode(std::vector<VkPresentModeKHR> const &avail
   return VK_PRESENT_MODE_FIFO_KHR;
 }
 
+uint32_t Swapchain::chooseImageCount(VkSurfaceCapabilitiesKHR const &capabilities,
+                                     uint32_t const &requestedImageCount) {
+  uint32_t const imageCount =
+      requestedImageCount > 0 ? std::max(requestedImageCount, capabilities.minImageCount)
+                              : capabilities.minImageCount + 1;
+
+  // a maximum of 0 means there is no limit
+  return capabilities.maxImageCount > 0 ? std::min(imageCount, capabilities.maxImageCount)
+                                        : imageCount;
+}
+
 VkExtent2D Swapchain::getSwapchainExtent(VkSurfaceCapabilitiesKHR const &capabilities,
                                          Window const &window) {
   if (capabilities.currentExtent.width != UINT32_MAX) {
@@ -117,14 +164,18 @@ VkFormat Swapchain::getSupportedDepthBufferFormat(GPU const &gpu) {
 
 void Swapchain::createRenderPass() {
   VkAttachmentDescription colorAttachment{};
-  colorAttachment.format = getSupportedSwapchainSurfaceFormat(swapchainSupportDetails).format;
+  colorAttachment.format = isOffscreen()
+                               ? mOffscreenFormat
+                               : getSupportedSwapchainSurfaceFormat(swapchainSupportDetails).format;
   colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
   colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
   colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
   colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
   colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
   colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-  colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+  // offscreen images are left ready to be copied out
+  colorAttachment.finalLayout =
+      isOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
   VkAttachmentReference colorAttachmentReference;
   colorAttachmentReference.attachment = 0;
@@ -178,16 +229,13 @@ void Swapchain::createSwapchain(Window const &window) {
 
   VkFormat format = surfaceFormat.format;
 
-  VkPresentModeKHR const presentMode =
-      chooseSwapchainPresentMode(swapchainSupportDetails.presentModes, !mGPU.isDedicated());
+  VkPresentModeKHR const presentMode = chooseSwapchainPresentMode(
+      swapchainSupportDetails.presentModes, mRequestedPresentMode, !mGPU.isDedicated());
 
   VkExtent2D extent = getSwapchainExtent(swapchainSupportDetails.capabilities, window);
 
   uint32_t const minimumImageCount =
-      swapchainSupportDetails.capabilities.maxImageCount > 0
-          ? std::min(swapchainSupportDetails.capabilities.minImageCount + 1,
-                     swapchainSupportDetails.capabilities.maxImageCount)
-          : swapchainSupportDetails.capabilities.minImageCount + 1;
+      chooseImageCount(swapchainSupportDetails.capabilities, mRequestedImageCount);
 
   std::set<uint32_t> uniqueQueueFamilyIndices{mGPU.queueFamilyIndices.graphics,
                                               mGPU.queueFamilyIndices.present};
@@ -232,6 +280,25 @@ void Swapchain::createSwapchain(Window const &window) {
     mMemoryManager.createImageView(frameBufferImages[i], VK_IMAGE_VIEW_TYPE_2D);
   }
 
+  createDepthBufferAndFramebuffers();
+}
+
+void Swapchain::createOffscreenImages(VkExtent2D const &extent) {
+  // enough images for every frame that can be in flight to render to its own
+  uint32_t const imageCount = std::max(mRequestedImageCount, EngineConfig::MaxFramesInFlight);
+
+  frameBufferImages.clear();
+  for (uint32_t i = 0; i < imageCount; i++) {
+    frameBufferImages.push_back(mMemoryManager.createImage(
+        extent, 1, mOffscreenFormat, VK_IMAGE_TILING_OPTIMAL,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D));
+  }
+
+  createDepthBufferAndFramebuffers();
+}
+
+void Swapchain::createDepthBufferAndFramebuffers() {
   depthBufferImage = mMemoryManager.createImage(
       frameBufferImages[0].extent, 1, getSupportedDepthBufferFormat(mGPU), VK_IMAGE_TILING_OPTIMAL,
       VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
@@ -257,29 +324,75 @@ void Swapchain::createSwapchain(Window const &window) {
   }
 }
 
-void Swapchain::cleanSwapchain() {
-
-  mGPU.waitIdle();
-
-  for (VkFramebuffer const &framebuffer : framebuffers) {
+void Swapchain::destroyResources(RetiredResources &resources) {
+  for (VkFramebuffer const &framebuffer : resources.framebuffers) {
     vkDestroyFramebuffer(mGPU.device, framebuffer, nullptr);
   }
 
-  for (mem::Image image : frameBufferImages) {
-    vkDestroyImageView(mGPU.device, image.imageView, nullptr);
+  // swapchain images belong to the swapchain, only offscreen images are owned
+  for (mem::Image &image : resources.frameBufferImages) {
+    if (resources.swapchain == VK_NULL_HANDLE) {
+      mMemoryManager.destroyImage(image);
+    } else {
+      vkDestroyImageView(mGPU.device, image.imageView, nullptr);
+    }
   }
-  mMemoryManager.destroyImage(depthBufferImage);
-}
 
-void Swapchain::handleFrameBufferResize(Window const &window) {
-  cleanSwapchain();
+  mMemoryManager.destroyImage(resources.depthBufferImage);
 
+  if (resources.swapchain != VK_NULL_HANDLE) {
+    vkDestroySwapchainKHR(mGPU.device, resources.swapchain, nullptr);
+  }
+}
+
+bool Swapchain::handleFrameBufferResize(Window const &window) {
   swapchainSupportDetails = SwapchainSupportDetails{mGPU.physicalDevice, mGPU.renderSurface};
 
-  VkSwapchainKHR oldSwapchain = swapchain;
+  if (!isValid(window)) {
+    return false;
+  }
+
+  // frames submitted so far may still be rendering to the current images
+  mRetiredResources.push_back(RetiredResources{mGraphicsTimeline.getLastSubmittedValue(), false,
+                                               swapchain, frameBufferImages, depthBufferImage,
+                                               framebuffers});
+
+  // the current handle is passed as oldSwapchain so the presentation engine can reuse its images
   createSwapchain(window);
+  return true;
+}
+
+void Swapchain::destroyRetiredResources() {
+  while (!mRetiredResources.empty() &&
+         mGraphicsTimeline.isComplete(mRetiredResources.front().timelineValue)) {
+    RetiredResources &resources = mRetiredResources.front();
+
+    // the old images may still be queued for presentation after their last frame finished
+    // rendering, they are released once a frame submitted from now on has finished too
+    if (!resources.waitingForPresents) {
+      resources.waitingForPresents = true;
+      resources.timelineValue = mGraphicsTimeline.getLastSubmittedValue() + 1;
+      return;
+    }
+
+    destroyResources(resources);
+    mRetiredResources.pop_front();
+  }
+}
+
+bool Swapchain::reconfigure(Window const &window, EngineConfig const &config) {
+  mRequestedPresentMode = config.presentMode;
+  mRequestedImageCount = config.swapchainImageCount;
+
+  return handleFrameBufferResize(window);
+}
+
+bool Swapchain::isOffscreen() const { return mGPU.isHeadless(); }
 
-  vkDestroySwapchainKHR(mGPU.device, oldSwapchain, nullptr);
+uint32_t Swapchain::acquireOffscreenImage() {
+  uint32_t const imageIndex = mNextOffscreenImage;
+  mNextOffscreenImage = (mNextOffscreenImage + 1) % static_cast<uint32_t>(frameBufferImages.size());
+  return imageIndex;
 }
 
 float Swapchain::getAspectRatio() const {
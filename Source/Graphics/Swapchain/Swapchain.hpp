@@ -1,11 +1,14 @@
 ﻿#pragma once
 
+#include <deque>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 
+#include "Graphics/Engine/EngineConfig.hpp"
 #include "Graphics/GPU/GPU.hpp"
 #include "Graphics/Memory/Image/Image.hpp"
+#include "Graphics/Timeline/Timeline.hpp"
 #include "Graphics/Window/Window.hpp"
 
 namespace cbl::gfx {
@@ -28,10 +31,32 @@ struct Swapchain {
 private:
   mem::MemoryManager &mMemoryManager;
   GPU const &mGPU;
+  Timeline &mGraphicsTimeline;
+
+  // Resources of a replaced swapchain, kept alive until the frames rendering to them retire. Their
+  // presents are not on the timeline, so the resources then also wait for one more frame
+  struct RetiredResources {
+    uint64_t timelineValue{};
+    bool waitingForPresents{false};
+    VkSwapchainKHR swapchain{};
+    std::vector<mem::Image> frameBufferImages{};
+    mem::Image depthBufferImage{};
+    std::vector<VkFramebuffer> framebuffers{};
+  };
+  std::deque<RetiredResources> mRetiredResources{};
+
+  EngineConfig::PresentMode mRequestedPresentMode{EngineConfig::PresentMode::eAuto};
+  uint32_t mRequestedImageCount{0};
+
+  static constexpr VkFormat mOffscreenFormat = VK_FORMAT_B8G8R8A8_SRGB;
+  uint32_t mNextOffscreenImage{0};
 
   [[nodiscard]] static VkPresentModeKHR
   chooseSwapchainPresentMode(std::vector<VkPresentModeKHR> const &availablePresentModes,
+                             EngineConfig::PresentMode const &requestedPresentMode,
                              bool const &vsync);
+  [[nodiscard]] static uint32_t chooseImageCount(VkSurfaceCapabilitiesKHR const &capabilities,
+                                                 uint32_t const &requestedImageCount);
   [[nodiscard]] static VkExtent2D getSwapchainExtent(VkSurfaceCapabilitiesKHR const &capabilities,
                                                      Window const &window);
 
@@ -42,7 +67,9 @@ private:
   void createRenderPass();
 
   void createSwapchain(Window const &window);
-  void cleanSwapchain();
+  void createOffscreenImages(VkExtent2D const &extent);
+  void createDepthBufferAndFramebuffers();
+  void destroyResources(RetiredResources &resources);
 
 public:
   VkRenderPass renderPass{};
@@ -54,10 +81,21 @@ public:
 
   Swapchain() = delete;
   Swapchain(Swapchain const &swapchain) = delete;
-  Swapchain(GPU const &gpu, Window const &window, mem::MemoryManager &memoryManager);
+  // without a window, renders to config.width x config.height images that are never presented
+  Swapchain(GPU const &gpu, Window const *window, mem::MemoryManager &memoryManager,
+            Timeline &graphicsTimeline, EngineConfig const &config);
   ~Swapchain();
 
-  void handleFrameBufferResize(Window const &window);
+  // Recreates the swapchain without waiting for the device. Returns false when the window has no
+  // drawable area, in which case the current swapchain is kept.
+  bool handleFrameBufferResize(Window const &window);
+  // same as handleFrameBufferResize, with the present mode and image count of config
+  bool reconfigure(Window const &window, EngineConfig const &config);
+  void destroyRetiredResources();
+
+  [[nodiscard]] bool isOffscreen() const;
+  // round-robins over the offscreen images, which are never held by a presentation engine
+  [[nodiscard]] uint32_t acquireOffscreenImage();
 
   [[nodiscard]] float getAspectRatio() const;
   [[nodiscard]] bool isValid(Window const &window) const;
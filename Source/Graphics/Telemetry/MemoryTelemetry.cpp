@@ -0,0 +1,127 @@
+#include "MemoryTelemetry.hpp"
+
+#include "External/imgui/imgui.h"
+
+#include "Core/Trace/Trace.hpp"
+
+namespace cbl::gfx {
+
+namespace {
+constexpr double BytesPerMiB = 1024.0 * 1024.0;
+
+double toMiB(VkDeviceSize const &bytes) { return static_cast<double>(bytes) / BytesPerMiB; }
+} // namespace
+
+MemoryTelemetry::MemoryTelemetry(mem::MemoryManager const &memoryManager,
+                                 mem::ResidencyManager const &residency,
+                                 uint32_t const &logIntervalSeconds)
+    : mMemoryManager{memoryManager}, mResidency{residency}, mLogInterval{logIntervalSeconds},
+      mStart{std::chrono::steady_clock::now()}, mLastLog{mStart} {}
+
+void MemoryTelemetry::sample(World const &world) {
+  CBL_TRACE_SCOPE("MemoryTelemetry::sample");
+  mStats = mMemoryManager.calculateStats();
+  mChunkStats = world.chunkStats;
+
+  mMeshCount = world.meshes.size();
+  mVertexCount = 0;
+  mIndexCount = 0;
+  mCpuMeshBytes = 0;
+  for (Mesh const &mesh : world.meshes) {
+    mVertexCount += mesh.vertices.size();
+    mIndexCount += mesh.indices.size();
+    mCpuMeshBytes += mesh.getRequiredBufferSize();
+  }
+
+  mHasSample = true;
+}
+
+void MemoryTelemetry::update(World const &world, std::ostream &log) {
+  auto const now = std::chrono::steady_clock::now();
+
+  if (!mHasSample || now - mLastSample >= mSampleInterval) {
+    sample(world);
+    mLastSample = now;
+  }
+
+  if (mLogInterval.count() > 0 && now - mLastLog >= mLogInterval) {
+    writeJson(log);
+    log << '\n';
+    log.flush();
+    mLastLog = now;
+  }
+}
+
+void MemoryTelemetry::drawImGui() const {
+  if (!mHasSample) {
+    ImGui::TextUnformatted("No sample yet");
+    return;
+  }
+
+  ImGui::Text("%-12s %8s %10s", "Category", "Count", "MiB");
+  for (size_t i = 0; i < mem::AllocationCategoryCount; i++) {
+    ImGui::Text("%-12s %8u %10.2f", mem::toString(static_cast<mem::AllocationCategory>(i)),
+                mStats.categories[i].count, toMiB(mStats.categories[i].bytes));
+  }
+
+  ImGui::Separator();
+  ImGui::Text("%-6s %-6s %9s %9s %9s %7s %7s", "Heap", "Local", "Size", "Usage", "Budget",
+              "Blocks", "Allocs");
+  for (size_t i = 0; i < mStats.heaps.size(); i++) {
+    mem::MemoryHeapStats const &heap = mStats.heaps[i];
+    ImGui::Text("%-6zu %-6s %9.1f %9.1f %9.1f %7u %7u", i, heap.deviceLocal ? "yes" : "no",
+                toMiB(heap.size), toMiB(heap.usage), toMiB(heap.budget), heap.blockCount,
+                heap.allocationCount);
+  }
+  ImGui::TextUnformatted("Heap sizes, usage and budgets in MiB");
+
+  ImGui::Separator();
+  ImGui::Text("Resident meshes : %u (%.2f MiB), %u evicted since load",
+              mResidency.getResidentMeshCount(), toMiB(mResidency.getResidentMeshBytes()),
+              mResidency.getEvictedMeshCount());
+  ImGui::Text("Budget target : %.0f%%", mResidency.getBudgetFraction() * 100.0f);
+
+  ImGui::Separator();
+  ImGui::Text("Chunks : %zu, block storage %.2f MiB", mChunkStats.chunkCount,
+              toMiB(mChunkStats.blockStorageBytes));
+  ImGui::Text("Meshes : %zu, %.1f vertices and %.1f indices on average, %.2f MiB on the CPU",
+              mMeshCount,
+              mMeshCount > 0 ? static_cast<double>(mVertexCount) / mMeshCount : 0.0,
+              mMeshCount > 0 ? static_cast<double>(mIndexCount) / mMeshCount : 0.0,
+              toMiB(mCpuMeshBytes));
+}
+
+void MemoryTelemetry::writeJson(std::ostream &stream) const {
+  double const seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+
+  stream << "{\"type\": \"memory\", \"seconds\": " << seconds << ", \"categories\": {";
+  for (size_t i = 0; i < mem::AllocationCategoryCount; i++) {
+    stream << (i > 0 ? ", " : "") << '"' << mem::toString(static_cast<mem::AllocationCategory>(i))
+           << "\": {\"count\": " << mStats.categories[i].count
+           << ", \"bytes\": " << mStats.categories[i].bytes << "}";
+  }
+
+  stream << "}, \"heaps\": [";
+  for (size_t i = 0; i < mStats.heaps.size(); i++) {
+    mem::MemoryHeapStats const &heap = mStats.heaps[i];
+    stream << (i > 0 ? ", " : "") << "{\"size\": " << heap.size
+           << ", \"deviceLocal\": " << (heap.deviceLocal ? "true" : "false")
+           << ", \"usage\": " << heap.usage << ", \"budget\": " << heap.budget
+           << ", \"blocks\": " << heap.blockCount << ", \"allocations\": " << heap.allocationCount
+           << ", \"usedBytes\": " << heap.usedBytes << ", \"unusedBytes\": " << heap.unusedBytes
+           << "}";
+  }
+
+  stream << "], \"residency\": {\"meshes\": " << mResidency.getResidentMeshCount()
+         << ", \"bytes\": " << mResidency.getResidentMeshBytes()
+         << ", \"evicted\": " << mResidency.getEvictedMeshCount()
+         << ", \"budgetFraction\": " << mResidency.getBudgetFraction() << "}";
+
+  stream << ", \"chunks\": {\"count\": " << mChunkStats.chunkCount
+         << ", \"blockStorageBytes\": " << mChunkStats.blockStorageBytes
+         << ", \"meshes\": " << mMeshCount << ", \"vertices\": " << mVertexCount
+         << ", \"indices\": " << mIndexCount << ", \"cpuMeshBytes\": " << mCpuMeshBytes << "}}";
+}
+
+} // namespace cbl::gfx
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#include "Core/World/World.hpp"
+#include "Graphics/Memory/MemoryManager/MemoryManager.hpp"
+#include "Graphics/Memory/Residency/ResidencyManager.hpp"
+
+namespace cbl::gfx {
+// Memory use of the renderer and of the chunks, sampled once per second since VMA has to walk
+// every allocation for its statistics. Shown in an ImGui window, and written as one JSON object
+// per line at a fixed interval so that runs can be graphed and leaks spotted
+struct MemoryTelemetry {
+private:
+  static constexpr std::chrono::seconds mSampleInterval{1};
+
+  mem::MemoryManager const &mMemoryManager;
+  mem::ResidencyManager const &mResidency;
+  std::chrono::seconds mLogInterval;
+
+  std::chrono::steady_clock::time_point mStart{};
+  std::chrono::steady_clock::time_point mLastSample{};
+  std::chrono::steady_clock::time_point mLastLog{};
+  bool mHasSample = false;
+
+  mem::MemoryStats mStats{};
+  ChunkStats mChunkStats{};
+  size_t mMeshCount = 0;
+  size_t mVertexCount = 0;
+  size_t mIndexCount = 0;
+  size_t mCpuMeshBytes = 0; // vertices and indices the meshes keep for re-uploads
+
+  void sample(World const &world);
+
+public:
+  MemoryTelemetry() = delete;
+  MemoryTelemetry(MemoryTelemetry const &) = delete;
+  // a logIntervalSeconds of 0 never writes the log line
+  MemoryTelemetry(mem::MemoryManager const &memoryManager, mem::ResidencyManager const &residency,
+                  uint32_t const &logIntervalSeconds);
+
+  void operator=(MemoryTelemetry const &) = delete;
+
+  // once per frame, samples when the last sample is old enough and logs when the interval elapsed
+  void update(World const &world, std::ostream &log);
+
+  void drawImGui() const;
+  // the last sample, as one line of JSON
+  void writeJson(std::ostream &stream) const;
+};
+} // namespace cbl::gfx
@@ -0,0 +1,187 @@
+#include "Timeline.hpp"
+
+#include <algorithm>
+
+#include "Graphics/Utils/VulkanHelpers.hpp"
+
+namespace cbl::gfx {
+
+Timeline::Timeline(GPU const &gpu, VkQueue const &queue) : mGPU{gpu}, mQueue{queue} {
+  if (!mGPU.supportsTimelineSemaphores) {
+    return;
+  }
+
+  VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo{};
+  semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+  semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+  semaphoreTypeCreateInfo.initialValue = 0;
+
+  VkSemaphoreCreateInfo semaphoreCreateInfo{};
+  semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+  semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+
+  validateVkResult(vkCreateSemaphore(mGPU.device, &semaphoreCreateInfo, nullptr, &mSemaphore));
+}
+
+Timeline::~Timeline() {
+  wait(mLastSubmittedValue);
+
+  for (VkFence const &fence : mFreeFences) {
+    vkDestroyFence(mGPU.device, fence, nullptr);
+  }
+
+  vkDestroySemaphore(mGPU.device, mSemaphore, nullptr);
+}
+
+VkFence Timeline::acquireFence() {
+  retireSignaledFences();
+
+  if (!mFreeFences.empty()) {
+    VkFence fence = mFreeFences.back();
+    mFreeFences.pop_back();
+    return fence;
+  }
+
+  VkFenceCreateInfo fenceCreateInfo{};
+  fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+  VkFence fence{};
+  validateVkResult(vkCreateFence(mGPU.device, &fenceCreateInfo, nullptr, &fence));
+  return fence;
+}
+
+void Timeline::retireSignaledFences() {
+  while (!mPendingFences.empty() &&
+         vkGetFenceStatus(mGPU.device, mPendingFences.front().second) == VK_SUCCESS) {
+    auto const [value, fence] = mPendingFences.front();
+    mPendingFences.pop_front();
+
+    validateVkResult(vkResetFences(mGPU.device, 1, &fence));
+    mFreeFences.push_back(fence);
+    mCompletedValue = value;
+  }
+}
+
+uint64_t Timeline::submit(VkCommandBuffer const &commandBuffer, std::vector<Wait> const &waits,
+                          std::vector<VkSemaphore> const &signalSemaphores) {
+  uint64_t const signalValue = mLastSubmittedValue + 1;
+
+  std::vector<VkSemaphore> waitSemaphores{};
+  std::vector<VkPipelineStageFlags> waitStages{};
+  std::vector<uint64_t> waitValues{};
+  for (Wait const &wait : waits) {
+    waitSemaphores.push_back(wait.semaphore);
+    waitStages.push_back(wait.stage);
+    waitValues.push_back(wait.value);
+  }
+
+  std::vector<VkSemaphore> semaphoresToSignal{signalSemaphores};
+  std::vector<uint64_t> signalValues(semaphoresToSignal.size(), 0);
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+
+  VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+  timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+
+  VkFence fence = VK_NULL_HANDLE;
+
+  if (usesTimelineSemaphore()) {
+    semaphoresToSignal.push_back(mSemaphore);
+    signalValues.push_back(signalValue);
+
+    timelineSubmitInfo.waitSemaphoreValueCount = static_cast<uint32_t>(waitValues.size());
+    timelineSubmitInfo.pWaitSemaphoreValues = waitValues.data();
+    timelineSubmitInfo.signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size());
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues.data();
+    submitInfo.pNext = &timelineSubmitInfo;
+  } else {
+    fence = acquireFence();
+  }
+
+  submitInfo.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size());
+  submitInfo.pWaitSemaphores = waitSemaphores.data();
+  submitInfo.pWaitDstStageMask = waitStages.data();
+  submitInfo.signalSemaphoreCount = static_cast<uint32_t>(semaphoresToSignal.size());
+  submitInfo.pSignalSemaphores = semaphoresToSignal.data();
+
+  validateVkResult(vkQueueSubmit(mQueue, 1, &submitInfo, fence));
+
+  if (fence != VK_NULL_HANDLE) {
+    mPendingFences.emplace_back(signalValue, fence);
+  }
+
+  mLastSubmittedValue = signalValue;
+  return signalValue;
+}
+
+void Timeline::dependOnPendingWork(std::vector<Wait> &waits, VkPipelineStageFlags const &stage) {
+  if (isComplete(mLastSubmittedValue)) {
+    return;
+  }
+
+  if (usesTimelineSemaphore()) {
+    waits.push_back(Wait{mSemaphore, stage, mLastSubmittedValue});
+  } else {
+    wait(mLastSubmittedValue);
+  }
+}
+
+bool Timeline::isComplete(uint64_t const &value) { return getCompletedValue() >= value; }
+
+void Timeline::wait(uint64_t const &value) {
+  if (value <= mCompletedValue) {
+    return;
+  }
+
+  if (usesTimelineSemaphore()) {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &mSemaphore;
+    waitInfo.pValues = &value;
+
+    validateVkResult(vkWaitSemaphores(mGPU.device, &waitInfo, UINT64_MAX));
+    mCompletedValue = std::max(mCompletedValue, value);
+    return;
+  }
+
+  auto const pending =
+      std::find_if(mPendingFences.begin(), mPendingFences.end(),
+                   [&value](std::pair<uint64_t, VkFence> const &p) { return p.first >= value; });
+
+  if (pending == mPendingFences.end()) {
+    return;
+  }
+
+  uint64_t const signaledValue = pending->first;
+  validateVkResult(vkWaitForFences(mGPU.device, 1, &pending->second, VK_TRUE, UINT64_MAX));
+
+  // a fence signal covers every batch submitted before it on the same queue
+  retireSignaledFences();
+  mCompletedValue = std::max(mCompletedValue, signaledValue);
+}
+
+uint64_t Timeline::getCompletedValue() {
+  if (mCompletedValue == mLastSubmittedValue) {
+    return mCompletedValue;
+  }
+
+  if (usesTimelineSemaphore()) {
+    uint64_t value{};
+    validateVkResult(vkGetSemaphoreCounterValue(mGPU.device, mSemaphore, &value));
+    mCompletedValue = std::max(mCompletedValue, value);
+  } else {
+    retireSignaledFences();
+  }
+
+  return mCompletedValue;
+}
+
+uint64_t Timeline::getLastSubmittedValue() const { return mLastSubmittedValue; }
+
+bool Timeline::usesTimelineSemaphore() const { return mSemaphore != VK_NULL_HANDLE; }
+
+} // namespace cbl::gfx
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "Graphics/GPU/GPU.hpp"
+
+namespace cbl::gfx {
+// Monotonic counter of the work submitted to a queue. Every submission made through the timeline
+// signals the next value, so CPU code can poll for completion instead of blocking on a fence.
+// Backed by a timeline semaphore when the device supports them, by a pool of fences otherwise.
+struct Timeline {
+public:
+  struct Wait {
+    VkSemaphore semaphore{};
+    VkPipelineStageFlags stage{};
+    uint64_t value{0}; // ignored for binary semaphores
+  };
+
+private:
+  GPU const &mGPU;
+  VkQueue mQueue{};
+
+  VkSemaphore mSemaphore{};
+  uint64_t mLastSubmittedValue{0};
+  uint64_t mCompletedValue{0};
+
+  std::deque<std::pair<uint64_t, VkFence>> mPendingFences{};
+  std::vector<VkFence> mFreeFences{};
+
+  [[nodiscard]] VkFence acquireFence();
+  void retireSignaledFences();
+
+public:
+  Timeline() = delete;
+  Timeline(Timeline const &) = delete;
+  Timeline(GPU const &gpu, VkQueue const &queue);
+  ~Timeline();
+
+  void operator=(Timeline const &) = delete;
+
+  uint64_t submit(VkCommandBuffer const &commandBuffer, std::vector<Wait> const &waits = {},
+                  std::vector<VkSemaphore> const &signalSemaphores = {});
+
+  // Makes a submission on another queue wait for everything submitted on this timeline so far.
+  // Without timeline semaphore support, the dependency is resolved on the CPU instead.
+  void dependOnPendingWork(std::vector<Wait> &waits, VkPipelineStageFlags const &stage);
+
+  [[nodiscard]] bool isComplete(uint64_t const &value);
+  void wait(uint64_t const &value);
+
+  [[nodiscard]] uint64_t getCompletedValue();
+  [[nodiscard]] uint64_t getLastSubmittedValue() const;
+  [[nodiscard]] bool usesTimelineSemaphore() const;
+};
+} // namespace cbl::gfx
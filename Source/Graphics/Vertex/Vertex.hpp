@@ -1,16 +1,11 @@
 #pragma once
 
-#include <array>
-
 #include <glm/glm.hpp>
-#include <vulkan/vulkan.h>
 
 namespace cbl::gfx {
+// plain vertex data, see VertexLayout for how it is fed to the vertex shader
 struct Vertex {
   glm::vec3 position;
   glm::vec3 uvw;
-
-  static VkVertexInputBindingDescription getVulkanBindingDescription();
-  static std::array<VkVertexInputAttributeDescription, 2> getVulkanAttributeDescriptions();
 };
-} // namespace cbl::gfx
\ No newline at end of file
+} // namespace cbl::gfx
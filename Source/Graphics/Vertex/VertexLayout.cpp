@@ -1,7 +1,9 @@
-#include "Vertex.hpp"
+#include "VertexLayout.hpp"
+
+#include <cstddef>
 
 namespace cbl::gfx {
-VkVertexInputBindingDescription Vertex::getVulkanBindingDescription() {
+VkVertexInputBindingDescription VertexLayout::getVulkanBindingDescription() {
   VkVertexInputBindingDescription bindingDescription;
 
   bindingDescription.binding = 0;
@@ -11,7 +13,7 @@ VkVertexInputBindingDescription Vertex::getVulkanBindingDescription() {
   return bindingDescription;
 }
 
-std::array<VkVertexInputAttributeDescription, 2> Vertex::getVulkanAttributeDescriptions() {
+std::array<VkVertexInputAttributeDescription, 2> VertexLayout::getVulkanAttributeDescriptions() {
   std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
 
   // position
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <array>
+
+#include <vulkan/vulkan.h>
+
+#include "Graphics/Vertex/Vertex.hpp"
+
+namespace cbl::gfx {
+struct VertexLayout {
+  VertexLayout() = delete;
+
+  [[nodiscard]] static VkVertexInputBindingDescription getVulkanBindingDescription();
+  [[nodiscard]] static std::array<VkVertexInputAttributeDescription, 2>
+  getVulkanAttributeDescriptions();
+};
+} // namespace cbl::gfx
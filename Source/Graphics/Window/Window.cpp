@@ -46,6 +46,12 @@ void Window::update() {
     case SDL_QUIT:
       mIsOpen = false;
       break;
+    case SDL_WINDOWEVENT:
+      if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        mResizePending = true;
+        mLastResizeTicks = SDL_GetTicks();
+      }
+      break;
     default:
       break;
     }
@@ -58,6 +64,15 @@ void Window::update() {
 
 bool Window::isOpen() const { return mIsOpen; }
 
+bool Window::consumeSettledResize(uint32_t const &settleMs) {
+  if (!mResizePending || SDL_GetTicks() - mLastResizeTicks < settleMs) {
+    return false;
+  }
+
+  mResizePending = false;
+  return true;
+}
+
 std::vector<char const *> Window::getRequiredVulkanExtensions() const {
   unsigned int count = 0;
 
@@ -14,6 +14,9 @@ private:
   SDL_Window *mSDLWindow{};
   bool mIsOpen = true;
 
+  bool mResizePending = false;
+  uint32_t mLastResizeTicks = 0;
+
 public:
   Window(Window const &) = delete;
   explicit Window(int const &width = 1280, int const &height = 720, bool const &fullscreen = false);
@@ -28,6 +31,9 @@ public:
 
   [[nodiscard]] bool isOpen() const;
 
+  // Returns true once per burst of resize events, after no new resize happened for settleMs
+  [[nodiscard]] bool consumeSettledResize(uint32_t const &settleMs);
+
   [[nodiscard]] std::vector<char const *> getRequiredVulkanExtensions() const;
   [[nodiscard]] VkSurfaceKHR getDrawableVulkanSurface(VkInstance const &vulkanInstance) const;
   [[nodiscard]] VkExtent2D getDrawableVulkanSurfaceSize() const;
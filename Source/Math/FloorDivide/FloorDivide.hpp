@@ -0,0 +1,10 @@
+#pragma once
+
+namespace cbl {
+// Rounds towards negative infinity, unlike /. -1 / 16 gives -1 and not 0, so the chunks left of
+// the origin do not share a group with the ones right of it
+constexpr int floorDivide(int const &value, int const &divisor) {
+  int const quotient = value / divisor;
+  return quotient * divisor > value ? quotient - 1 : quotient;
+}
+} // namespace cbl